@@ -1,12 +1,39 @@
 #include "EBO.h"
 
-EBO::EBO(GLuint* indices, GLsizeiptr size)
+#include<algorithm>
+#include<vector>
+
+EBO::EBO(GLuint* indices, GLsizeiptr size, bool allowBytes)
 {
+	count = (GLsizei)(size / sizeof(GLuint));
+	GLuint largest = count > 0 ? *std::max_element(indices, indices + count) : 0;
+
 	glGenBuffers(1, &ID); //I beleive this function creates a general purpose OpenGL buffer
 	//Make the EBO the current object (binded object)
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);  //Must use GL_ELEMENT_ARRAY_BUFFER type when referencing index data
-	//Transfer data to the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+	//Transfer data to the buffer, in the smallest type the indices fit in
+	if (allowBytes && largest <= 0xFF)
+	{
+		type = GL_UNSIGNED_BYTE;
+		std::vector<GLubyte> narrow(indices, indices + count);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(GLubyte), narrow.data(), GL_STATIC_DRAW);
+	}
+	else if (largest <= 0xFFFF)
+	{
+		type = GL_UNSIGNED_SHORT;
+		std::vector<GLushort> narrow(indices, indices + count);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(GLushort), narrow.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		type = GL_UNSIGNED_INT;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+	}
+}
+
+GLsizei EBO::IndexSize()
+{
+	return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
 }
 
 void EBO::Bind()
@@ -20,4 +47,4 @@ void EBO::Unbind()
 void EBO::Delete()
 {
 	glDeleteBuffers(1, &ID);
-}
\ No newline at end of file
+}
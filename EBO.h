@@ -6,11 +6,21 @@ class EBO
 {
 public:
 	GLuint ID;
-	EBO(GLuint* indices, GLsizeiptr size);
+	//Type the indices are stored as, pass it to glDrawElements
+	GLenum type;
+	//Number of indices
+	GLsizei count;
+	//Indices are stored in the smallest type that holds the largest of them, which is
+	//GL_UNSIGNED_SHORT for any mesh under 65536 vertices. GL_UNSIGNED_BYTE is only used when
+	//allowBytes is set, since several GPUs convert 8 bit indices in the driver
+	EBO(GLuint* indices, GLsizeiptr size, bool allowBytes = false);
+
+	//Bytes one index takes
+	GLsizei IndexSize();
 
 	void Bind();
 	void Unbind();
 	void Delete();
 
 
-};
\ No newline at end of file
+};
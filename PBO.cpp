@@ -0,0 +1,144 @@
+#include "PBO.h"
+
+#include<cstring>
+
+PBO::PBO(GLsizeiptr size, GLsizeiptr frameBudget)
+	: size(size), frameBudget(frameBudget)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+	if (gl_extensions.bufferStorage)
+	{
+		// Immutable storage can stay mapped while the GPU reads from it
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PBO::BeginFrame() {
+	uploadedThisFrame = 0;
+	Retire();
+}
+
+bool PBO::HasBudget(GLsizeiptr bytes) {
+	return frameBudget == 0 || uploadedThisFrame == 0 || uploadedThisFrame + bytes <= frameBudget;
+}
+
+GLsizeiptr PBO::Room(GLsizeiptr minimum) {
+	// Without a budget only the ring limits how much goes out
+	GLsizeiptr room = frameBudget == 0 ? size : frameBudget - uploadedThisFrame;
+	if (uploadedThisFrame == 0 && room < minimum)
+		room = minimum;
+	if (room > size / 4)
+		room = size / 4 > minimum ? size / 4 : minimum;
+	return room;
+}
+
+bool PBO::Upload(Texture& texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, const void* texels, GLsizeiptr bytes) {
+	if (!HasBudget(bytes))
+		return false;
+	GLintptr offset = Allocate(bytes);
+	if (offset < 0)
+		return false;
+
+	Bind();
+	if (mapped != NULL)
+	{
+		memcpy(mapped + offset, texels, bytes);
+	}
+	else
+	{
+		// Unsynchronized is safe here since the fences already keep us off ranges still in use
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		void* range = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, bytes, flags);
+		// The driver may refuse the mapping, e.g. when out of memory; nothing was used yet so retry later
+		if (range == NULL)
+		{
+			Unbind();
+			return false;
+		}
+		memcpy(range, texels, bytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+
+	// With a pixel unpack buffer bound the pointer argument is an offset into that buffer
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	texture.SubImage(level, x, y, width, height, (const void*)offset);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	Unbind();
+
+	inFlight.push_back({ offset, offset + bytes, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+	head = offset + bytes;
+	uploadedThisFrame += bytes;
+	return true;
+}
+
+void PBO::Retire() {
+	while (!inFlight.empty())
+	{
+		GLenum status = glClientWaitSync(inFlight.front().fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+		glDeleteSync(inFlight.front().fence);
+		inFlight.pop_front();
+	}
+}
+
+GLintptr PBO::Allocate(GLsizeiptr bytes) {
+	if (bytes > size)
+		return -1;
+	Retire();
+	if (inFlight.empty())
+	{
+		head = 0;
+		return 0;
+	}
+	return pbo_ring_allocate(size, head, inFlight.front().start, bytes);
+}
+
+GLintptr pbo_ring_allocate(GLsizeiptr size, GLintptr head, GLintptr oldest, GLsizeiptr bytes) {
+	// Keep copies 16 byte aligned
+	GLintptr start = (head + 15) & ~(GLintptr)15;
+	if (head >= oldest)
+	{
+		// Free space runs from start to the end of the buffer, then from 0 up to the oldest range
+		if (start + bytes <= size)
+			return start;
+		// Stop short of the oldest range, a write ending on it would make the ring look empty
+		if (bytes < oldest)
+			return 0;
+		return -1;
+	}
+	// Already wrapped, the free space ends before the oldest range
+	if (start + bytes < oldest)
+		return start;
+	return -1;
+}
+
+void PBO::Bind() {
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+}
+
+void PBO::Unbind() {
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PBO::Delete() {
+	for (InFlight& range : inFlight)
+		glDeleteSync(range.fence);
+	inFlight.clear();
+	if (mapped != NULL)
+	{
+		Bind();
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		Unbind();
+		mapped = NULL;
+	}
+	glDeleteBuffers(1, &ID);
+}
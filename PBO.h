@@ -0,0 +1,65 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<deque>
+
+#include "glExtensions.h"
+#include "texture.h"
+
+//Ring size for uploads that have no per frame budget to size it from
+const GLsizeiptr PBO_UNLIMITED_SIZE = 32 * 1024 * 1024;
+
+//Where bytes go in a ring of size bytes whose oldest range still in flight starts at oldest and
+//whose last write ended at head, or -1 if they do not fit; for a ring with something in flight
+//Writes never end exactly at oldest, so head == oldest cannot be mistaken for an empty ring
+GLintptr pbo_ring_allocate(GLsizeiptr size, GLintptr head, GLintptr oldest, GLsizeiptr bytes);
+
+//Class streams texel data to textures through a ring of pixel unpack buffer memory
+//Texels are copied once into mapped memory and the driver transfers them to the
+//texture asynchronously. Fences stop the ring from overwriting data that is still in flight.
+class PBO
+{
+public:
+	GLuint ID;
+	GLsizeiptr size;
+	//Bytes that may be uploaded per frame, 0 for no limit
+	GLsizeiptr frameBudget;
+	GLsizeiptr uploadedThisFrame = 0;
+
+	PBO(GLsizeiptr size, GLsizeiptr frameBudget);
+
+	//Resets the per-frame budget, call once at the start of each frame
+	void BeginFrame();
+	//True if size more bytes fit in this frame's budget
+	//The first upload of a frame is always allowed so oversized ones are not starved
+	bool HasBudget(GLsizeiptr bytes);
+	//Bytes to send in the next upload: what is left of the budget, but at least minimum on the
+	//frame's first upload and never more than a quarter of the ring; negative once the budget is spent
+	GLsizeiptr Room(GLsizeiptr minimum);
+	//Copies a sub-rectangle of tightly packed texels into a texture level
+	//Returns false without uploading if the budget is spent or the ring is full; try again next frame
+	bool Upload(Texture& texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, const void* texels, GLsizeiptr bytes);
+
+	void Bind();
+	void Unbind();
+	void Delete();
+
+private:
+	//A range of the ring that the GPU may still be reading from
+	struct InFlight
+	{
+		GLintptr start;
+		GLintptr end;
+		GLsync fence;
+	};
+
+	//Persistently mapped pointer when ARB_buffer_storage is available
+	unsigned char* mapped = NULL;
+	GLintptr head = 0;
+	std::deque<InFlight> inFlight;
+
+	//Frees ranges whose fences have signaled
+	void Retire();
+	//Finds room for bytes in the ring, returning -1 if there is none
+	GLintptr Allocate(GLsizeiptr bytes);
+};
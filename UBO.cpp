@@ -0,0 +1,71 @@
+#include "UBO.h"
+
+#include<cstring>
+
+UBO::UBO(GLuint binding, GLsizeiptr size)
+	: binding(binding), size(size)
+{
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	stride = (size + alignment - 1) / alignment * alignment;
+
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	if (gl_extensions.bufferStorage)
+	{
+		// Mapped once for the life of the buffer, writes go straight to memory the GPU reads
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, stride * copies, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, stride * copies, flags);
+	}
+	else
+	{
+		glBufferData(GL_UNIFORM_BUFFER, stride * copies, NULL, GL_DYNAMIC_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::Update(const void* data) {
+	// Everything drawn with the previous copy has been issued by now
+	if (current >= 0)
+		fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	current = (current + 1) % copies;
+
+	// With three copies this almost never waits, it only matters if the GPU falls far behind
+	if (fences[current] != NULL)
+	{
+		glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(fences[current]);
+		fences[current] = NULL;
+	}
+
+	GLintptr offset = stride * current;
+	if (mapped != NULL)
+	{
+		memcpy(mapped + offset, data, size);
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, ID);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, ID, offset, size);
+}
+
+void UBO::Delete() {
+	for (GLsync& fence : fences)
+	{
+		if (fence != NULL)
+			glDeleteSync(fence);
+		fence = NULL;
+	}
+	if (mapped != NULL)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, ID);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		mapped = NULL;
+	}
+	glDeleteBuffers(1, &ID);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<glm/glm/glm.hpp>
+
+#include "glExtensions.h"
+
+//Uniform block binding point every program's FrameData block is bound to
+const GLuint FRAME_DATA_BINDING = 0;
+
+//Per frame values shared by all programs, laid out to match the std140 FrameData block in the shaders
+struct FrameData
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProj;
+	//std140 packs the float into the fourth component of the vec3's slot
+	glm::vec3 camPos;
+	float time;
+};
+static_assert(sizeof(FrameData) == 208, "FrameData must match the std140 layout of the FrameData block");
+
+//Class keeps a uniform block's data in one buffer that every program reads from a fixed binding point,
+//so it is written once per frame instead of once per program
+//The buffer holds three copies used in turn, so the CPU never writes one the GPU may still be reading
+class UBO
+{
+public:
+	GLuint ID;
+	GLuint binding;
+	GLsizeiptr size;
+
+	UBO(GLuint binding, GLsizeiptr size);
+
+	//Writes this frame's copy and binds it, call once per frame before drawing
+	void Update(const void* data);
+
+	void Delete();
+
+private:
+	static const int copies = 3;
+	//Distance between copies, rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	GLsizeiptr stride;
+	//Persistently mapped pointer when ARB_buffer_storage is available
+	unsigned char* mapped = NULL;
+	int current = -1;
+	//Signals when the GPU is done with the draws that read each copy
+	GLsync fences[copies] = {};
+};
@@ -4,13 +4,19 @@ VAO::VAO() {
 	glGenVertexArrays(1, &ID); //Must be generated before the VBO
 }
 
-void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset) {
+void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLboolean normalized) {
 	VBO.Bind();
-	glVertexAttribPointer(layout, numComponents, type, GL_FALSE, stride, offset);
+	glVertexAttribPointer(layout, numComponents, type, normalized, stride, offset);
 	//Enable the Vertex Attribute so that OpenGL knows to use it
 	glEnableVertexAttribArray(layout);
 	VBO.Unbind();
 }
+void VAO::LinkAttrib(StreamBuffer& buffer, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLboolean normalized) {
+	buffer.Bind();
+	glVertexAttribPointer(layout, numComponents, type, normalized, stride, offset);
+	glEnableVertexAttribArray(layout);
+	buffer.Unbind();
+}
 void VAO::Bind() {
 	glBindVertexArray(ID);
 }
@@ -2,6 +2,7 @@
 
 #include<glad/glad.h>
 #include "VBO.h"
+#include "streamBuffer.h"
 
 
 class VAO
@@ -10,7 +11,10 @@ public:
 	GLuint ID;
 	VAO();
 
-	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
+	//Normalized integer types are read as floats in 0..1, or -1..1 when signed
+	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLboolean normalized = GL_FALSE);
+	//Same for vertices streamed each frame; draw with the offset from Write divided by stride as the first vertex
+	void LinkAttrib(StreamBuffer& buffer, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLboolean normalized = GL_FALSE);
 	void Bind();
 	void Unbind();
 	void Delete();
@@ -1,6 +1,11 @@
 #include "VBO.h"
 
 VBO::VBO(GLfloat* vertices, GLsizeiptr size)
+	: VBO((const void*)vertices, size)
+{
+}
+
+VBO::VBO(const void* vertices, GLsizeiptr size)
 {
 	//In order to transfer vertex info between the CPU and the GPU, we must create a vertex buffer object
 	//(vbo is typically an array of references)
@@ -7,6 +7,8 @@ class VBO
 public:
 	GLuint ID;
 	VBO(GLfloat* vertices, GLsizeiptr size);
+	//For vertices stored as structs or packed formats
+	VBO(const void* vertices, GLsizeiptr size);
 
 	void Bind();
 	void Unbind();
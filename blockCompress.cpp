@@ -0,0 +1,177 @@
+#include "blockCompress.h"
+
+#include<cstring>
+
+static int blocksAcross(int size) {
+	return (size + 3) / 4;
+}
+
+size_t bc1_size(int width, int height) {
+	return (size_t)blocksAcross(width) * blocksAcross(height) * 8;
+}
+
+size_t bc3_size(int width, int height) {
+	return (size_t)blocksAcross(width) * blocksAcross(height) * 16;
+}
+
+//Copies a 4x4 block out of the image as RGBA, clamping reads at the image edges
+static void fetchBlock(const unsigned char* texels, int width, int height, int numColCh, int bx, int by, unsigned char block[16][4]) {
+	for (int y = 0; y < 4; y++)
+	{
+		int sy = by * 4 + y < height ? by * 4 + y : height - 1;
+		for (int x = 0; x < 4; x++)
+		{
+			int sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+			const unsigned char* src = texels + ((size_t)sy * width + sx) * numColCh;
+			block[y * 4 + x][0] = src[0];
+			block[y * 4 + x][1] = src[1];
+			block[y * 4 + x][2] = src[2];
+			block[y * 4 + x][3] = numColCh == 4 ? src[3] : 255;
+		}
+	}
+}
+
+static unsigned short to565(const int c[3]) {
+	return (unsigned short)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+}
+
+static void from565(unsigned short v, int c[3]) {
+	int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+	c[0] = (r << 3) | (r >> 2);
+	c[1] = (g << 2) | (g >> 4);
+	c[2] = (b << 3) | (b >> 2);
+}
+
+//Writes the 8 byte color part shared by BC1 and BC3
+static void encodeColor(const unsigned char block[16][4], unsigned char* out) {
+	// Use the corners of the color bounding box, pulled in by 1/16 so the
+	// palette covers the colors that are actually present instead of the extremes
+	int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			if (block[i][c] < lo[c]) lo[c] = block[i][c];
+			if (block[i][c] > hi[c]) hi[c] = block[i][c];
+		}
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (hi[c] - lo[c]) >> 4;
+		lo[c] += inset;
+		hi[c] -= inset;
+	}
+
+	unsigned short c0 = to565(hi), c1 = to565(lo);
+	// c0 > c1 selects the 4 color mode, equal endpoints can only use index 0
+	if (c0 < c1)
+	{
+		unsigned short t = c0; c0 = c1; c1 = t;
+	}
+	int palette[4][3];
+	from565(c0, palette[0]);
+	from565(c1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	unsigned int indices = 0;
+	if (c0 != c1)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestError = 0x7fffffff;
+			for (int p = 0; p < 4; p++)
+			{
+				int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+				int error = dr * dr + dg * dg + db * db;
+				if (error < bestError)
+				{
+					best = p;
+					bestError = error;
+				}
+			}
+			indices |= (unsigned int)best << (i * 2);
+		}
+	}
+
+	out[0] = (unsigned char)(c0 & 0xff);
+	out[1] = (unsigned char)(c0 >> 8);
+	out[2] = (unsigned char)(c1 & 0xff);
+	out[3] = (unsigned char)(c1 >> 8);
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+//Writes the 8 byte alpha part of BC3
+static void encodeAlpha(const unsigned char block[16][4], unsigned char* out) {
+	int a0 = 0, a1 = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		if (block[i][3] > a0) a0 = block[i][3];
+		if (block[i][3] < a1) a1 = block[i][3];
+	}
+	// a0 > a1 selects the mode with 6 interpolated values
+	int palette[8] = { a0, a1 };
+	for (int p = 1; p < 7; p++)
+		palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+	unsigned long long indices = 0;
+	if (a0 != a1)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestError = 256;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = block[i][3] > palette[p] ? block[i][3] - palette[p] : palette[p] - block[i][3];
+				if (error < bestError)
+				{
+					best = p;
+					bestError = error;
+				}
+			}
+			indices |= (unsigned long long)best << (i * 3);
+		}
+	}
+
+	out[0] = (unsigned char)a0;
+	out[1] = (unsigned char)a1;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+std::vector<unsigned char> encode_bc1(const unsigned char* texels, int width, int height, int numColCh) {
+	std::vector<unsigned char> result(bc1_size(width, height));
+	unsigned char* out = result.data();
+	unsigned char block[16][4];
+	for (int by = 0; by < blocksAcross(height); by++)
+	{
+		for (int bx = 0; bx < blocksAcross(width); bx++)
+		{
+			fetchBlock(texels, width, height, numColCh, bx, by, block);
+			encodeColor(block, out);
+			out += 8;
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> encode_bc3(const unsigned char* texels, int width, int height) {
+	std::vector<unsigned char> result(bc3_size(width, height));
+	unsigned char* out = result.data();
+	unsigned char block[16][4];
+	for (int by = 0; by < blocksAcross(height); by++)
+	{
+		for (int bx = 0; bx < blocksAcross(width); bx++)
+		{
+			fetchBlock(texels, width, height, 4, bx, by, block);
+			encodeAlpha(block, out);
+			encodeColor(block, out + 8);
+			out += 16;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include<cstddef>
+#include<vector>
+
+//CPU encoders for the BC1 and BC3 (DXT1/DXT5) block compressed formats
+//Both work on 4x4 texel blocks; partial blocks at the edges repeat their last row/column
+
+//Bytes needed for a BC1 image (8 bytes per block)
+size_t bc1_size(int width, int height);
+//Bytes needed for a BC3 image (16 bytes per block)
+size_t bc3_size(int width, int height);
+
+//Compresses tightly packed RGB or RGBA texels (numColCh 3 or 4) to BC1, alpha is ignored
+std::vector<unsigned char> encode_bc1(const unsigned char* texels, int width, int height, int numColCh);
+//Compresses tightly packed RGBA texels to BC3
+std::vector<unsigned char> encode_bc3(const unsigned char* texels, int width, int height);
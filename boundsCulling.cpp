@@ -0,0 +1,182 @@
+#include "boundsCulling.h"
+
+#include<cmath>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define BOUNDS_AVX2
+#define BOUNDS_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include<emmintrin.h>
+#define BOUNDS_SSE2
+#elif defined(__ARM_NEON)
+#include<arm_neon.h>
+#define BOUNDS_NEON
+#endif
+
+unsigned int BoundsCuller::AddBox(const glm::vec3& low, const glm::vec3& high) {
+	unsigned int index = (unsigned int)Size();
+	centerX.push_back(0.0f), centerY.push_back(0.0f), centerZ.push_back(0.0f);
+	extentX.push_back(0.0f), extentY.push_back(0.0f), extentZ.push_back(0.0f);
+	radius.push_back(0.0f);
+	SetBox(index, low, high);
+	return index;
+}
+
+unsigned int BoundsCuller::AddSphere(const glm::vec3& center, float r) {
+	unsigned int index = AddBox(center, center);
+	radius[index] = r;
+	return index;
+}
+
+void BoundsCuller::SetBox(unsigned int index, const glm::vec3& low, const glm::vec3& high) {
+	Set(index, (low + high) * 0.5f, (high - low) * 0.5f, 0.0f);
+}
+
+void BoundsCuller::SetSphere(unsigned int index, const glm::vec3& center, float r) {
+	Set(index, center, glm::vec3(0.0f), r);
+}
+
+void BoundsCuller::Set(unsigned int index, const glm::vec3& center, const glm::vec3& extents, float r) {
+	centerX[index] = center.x, centerY[index] = center.y, centerZ[index] = center.z;
+	extentX[index] = extents.x, extentY[index] = extents.y, extentZ[index] = extents.z;
+	radius[index] = r;
+}
+
+void BoundsCuller::Clear() {
+	centerX.clear(), centerY.clear(), centerZ.clear();
+	extentX.clear(), extentY.clear(), extentZ.clear();
+	radius.clear();
+}
+
+void BoundsCuller::Cull(const Frustum& frustum, std::vector<unsigned int>& visible, ThreadPool* pool, bool forceScalar) {
+	visible.clear();
+	size_t count = Size();
+	const size_t grain = 8192;
+	if (pool == NULL || count <= grain)
+	{
+		CullRange(0, count, frustum, visible, forceScalar);
+		return;
+	}
+
+	// Each chunk collects its own list, joined in chunk order so the result matches the single threaded one
+	size_t chunks = (count + grain - 1) / grain;
+	std::vector<std::vector<unsigned int>> chunkVisible(chunks);
+	pool->ParallelFor(count, grain, [&](size_t begin, size_t end) {
+		CullRange(begin, end, frustum, chunkVisible[begin / grain], forceScalar);
+	});
+	for (const std::vector<unsigned int>& chunk : chunkVisible)
+		visible.insert(visible.end(), chunk.begin(), chunk.end());
+}
+
+void BoundsCuller::CullRange(size_t begin, size_t end, const Frustum& frustum, std::vector<unsigned int>& visible, bool forceScalar) {
+	// An object is outside a plane when its center is further behind it than the box's projection
+	// onto the plane normal plus the radius
+	glm::vec4 absNormals[6];
+	for (int p = 0; p < 6; p++)
+		absNormals[p] = glm::abs(frustum.planes[p]);
+	size_t i = begin;
+	if (!forceScalar)
+	{
+#if defined(BOUNDS_AVX2)
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 cx = _mm256_loadu_ps(&centerX[i]), cy = _mm256_loadu_ps(&centerY[i]), cz = _mm256_loadu_ps(&centerZ[i]);
+			__m256 ex = _mm256_loadu_ps(&extentX[i]), ey = _mm256_loadu_ps(&extentY[i]), ez = _mm256_loadu_ps(&extentZ[i]);
+			__m256 r = _mm256_loadu_ps(&radius[i]);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; p++)
+			{
+				const glm::vec4& n = frustum.planes[p];
+				const glm::vec4& a = absNormals[p];
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(n.x), cx), _mm256_mul_ps(_mm256_set1_ps(n.y), cy)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(n.z), cz), _mm256_set1_ps(n.w)));
+				__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a.x), ex), _mm256_mul_ps(_mm256_set1_ps(a.y), ey)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a.z), ez), r));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, reach), _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			int mask = _mm256_movemask_ps(inside);
+			for (int lane = 0; lane < 8; lane++)
+			{
+				if (mask & (1 << lane))
+					visible.push_back((unsigned int)(i + lane));
+			}
+		}
+#endif
+#if defined(BOUNDS_SSE2)
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+			__m128 ex = _mm_loadu_ps(&extentX[i]), ey = _mm_loadu_ps(&extentY[i]), ez = _mm_loadu_ps(&extentZ[i]);
+			__m128 r = _mm_loadu_ps(&radius[i]);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++)
+			{
+				const glm::vec4& n = frustum.planes[p];
+				const glm::vec4& a = absNormals[p];
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.x), cx), _mm_mul_ps(_mm_set1_ps(n.y), cy)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.z), cz), _mm_set1_ps(n.w)));
+				__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.x), ex), _mm_mul_ps(_mm_set1_ps(a.y), ey)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.z), ez), r));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, reach), _mm_setzero_ps()));
+			}
+			int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (mask & (1 << lane))
+					visible.push_back((unsigned int)(i + lane));
+			}
+		}
+#elif defined(BOUNDS_NEON)
+		for (; i + 4 <= end; i += 4)
+		{
+			float32x4_t cx = vld1q_f32(&centerX[i]), cy = vld1q_f32(&centerY[i]), cz = vld1q_f32(&centerZ[i]);
+			float32x4_t ex = vld1q_f32(&extentX[i]), ey = vld1q_f32(&extentY[i]), ez = vld1q_f32(&extentZ[i]);
+			float32x4_t r = vld1q_f32(&radius[i]);
+			uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+			for (int p = 0; p < 6; p++)
+			{
+				const glm::vec4& n = frustum.planes[p];
+				const glm::vec4& a = absNormals[p];
+				float32x4_t d = vaddq_f32(vaddq_f32(vmulq_n_f32(cx, n.x), vmulq_n_f32(cy, n.y)), vaddq_f32(vmulq_n_f32(cz, n.z), vdupq_n_f32(n.w)));
+				float32x4_t reach = vaddq_f32(vaddq_f32(vmulq_n_f32(ex, a.x), vmulq_n_f32(ey, a.y)), vaddq_f32(vmulq_n_f32(ez, a.z), r));
+				inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(d, reach), vdupq_n_f32(0.0f)));
+			}
+			uint32_t lanes[4];
+			vst1q_u32(lanes, inside);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (lanes[lane])
+					visible.push_back((unsigned int)(i + lane));
+			}
+		}
+#endif
+	}
+	// Same test one object at a time, for the tail and for machines without SIMD
+	for (; i < end; i++)
+	{
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++)
+		{
+			const glm::vec4& n = frustum.planes[p];
+			const glm::vec4& a = absNormals[p];
+			float d = (n.x * centerX[i] + n.y * centerY[i]) + (n.z * centerZ[i] + n.w);
+			float reach = (a.x * extentX[i] + a.y * extentY[i]) + (a.z * extentZ[i] + radius[i]);
+			inside = d + reach >= 0.0f;
+		}
+		if (inside)
+			visible.push_back((unsigned int)i);
+	}
+}
+
+const char* bounds_simd_name() {
+#if defined(BOUNDS_AVX2)
+	return "AVX2";
+#elif defined(BOUNDS_SSE2)
+	return "SSE2";
+#elif defined(BOUNDS_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
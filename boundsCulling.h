@@ -0,0 +1,41 @@
+#pragma once
+
+#include<cstddef>
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "frustum.h"
+#include "threadPool.h"
+
+//Class holds the bounds of many objects and finds the ones inside a frustum
+//Boxes and spheres share one index space: each object is a box grown by a radius, so a box has
+//radius 0 and a sphere has no extents, and one kernel tests both exactly
+//Bounds are kept as one array per component so SIMD tests 4 or 8 objects at a time
+class BoundsCuller
+{
+public:
+	//Adds an axis aligned box or a sphere and returns its index
+	unsigned int AddBox(const glm::vec3& low, const glm::vec3& high);
+	unsigned int AddSphere(const glm::vec3& center, float radius);
+	//Moves an object that has already been added
+	void SetBox(unsigned int index, const glm::vec3& low, const glm::vec3& high);
+	void SetSphere(unsigned int index, const glm::vec3& center, float radius);
+	void Clear();
+	size_t Size() { return centerX.size(); }
+
+	//Replaces visible with the indices of objects touching the frustum, in increasing order
+	//With a pool, chunks of objects are tested in parallel
+	void Cull(const Frustum& frustum, std::vector<unsigned int>& visible, ThreadPool* pool = NULL, bool forceScalar = false);
+
+private:
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+	std::vector<float> radius;
+
+	void Set(unsigned int index, const glm::vec3& center, const glm::vec3& extents, float r);
+	//Tests objects [begin, end), appending the visible ones
+	void CullRange(size_t begin, size_t end, const Frustum& frustum, std::vector<unsigned int>& visible, bool forceScalar);
+};
+
+//Name of the instruction set BoundsCuller uses
+const char* bounds_simd_name();
@@ -0,0 +1,263 @@
+#include "bufferArena.h"
+
+#include<algorithm>
+
+RangeAllocator::RangeAllocator(size_t capacity)
+	: capacity(capacity)
+{
+	if (capacity > 0)
+		freeRanges[0] = capacity;
+}
+
+long long RangeAllocator::Allocate(size_t count) {
+	// Best fit keeps large ranges whole for large meshes
+	auto best = freeRanges.end();
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+	{
+		if (it->second >= count && (best == freeRanges.end() || it->second < best->second))
+			best = it;
+	}
+	if (best == freeRanges.end())
+		return -1;
+	size_t offset = best->first;
+	size_t remaining = best->second - count;
+	freeRanges.erase(best);
+	if (remaining > 0)
+		freeRanges[offset + count] = remaining;
+	return (long long)offset;
+}
+
+void RangeAllocator::Free(size_t offset, size_t count) {
+	if (count == 0)
+		return;
+	auto next = freeRanges.lower_bound(offset);
+	// Merge with the free range just after this one
+	if (next != freeRanges.end() && offset + count == next->first)
+	{
+		count += next->second;
+		next = freeRanges.erase(next);
+	}
+	// And with the one just before
+	if (next != freeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += count;
+			return;
+		}
+	}
+	freeRanges[offset] = count;
+}
+
+void RangeAllocator::Grow(size_t newCapacity) {
+	if (newCapacity <= capacity)
+		return;
+	size_t added = newCapacity - capacity;
+	size_t offset = capacity;
+	capacity = newCapacity;
+	Free(offset, added);
+}
+
+size_t RangeAllocator::FreeCount() {
+	size_t count = 0;
+	for (auto& range : freeRanges)
+		count += range.second;
+	return count;
+}
+
+size_t RangeAllocator::LargestFree() {
+	size_t largest = 0;
+	for (auto& range : freeRanges)
+		largest = std::max(largest, range.second);
+	return largest;
+}
+
+BufferArena::BufferArena(GLsizei stride, GLuint vertexCapacity, GLuint indexCapacity)
+	: stride(stride), vertices(vertexCapacity), indices(indexCapacity)
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &vertexBuffer);
+	glGenBuffers(1, &indexBuffer);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * stride, NULL, GL_STATIC_DRAW);
+	// The index buffer binding is part of the VAO, so it is set once here
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BufferArena::LinkAttrib(GLuint layout, GLuint numComponents, GLenum type, size_t offset, GLboolean normalized) {
+	attribs.push_back({ layout, numComponents, type, offset, normalized });
+	LinkAttribs();
+}
+
+void BufferArena::LinkAttribs() {
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	for (Attrib& attrib : attribs)
+	{
+		glVertexAttribPointer(attrib.layout, attrib.numComponents, attrib.type, attrib.normalized, stride, (void*)attrib.offset);
+		glEnableVertexAttribArray(attrib.layout);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshHandle BufferArena::Add(const void* vertexData, GLuint vertexCount, const GLuint* indexData, GLsizei indexCount) {
+	long long baseVertex = vertices.Allocate(vertexCount);
+	long long firstIndex = indices.Allocate(indexCount);
+	if (baseVertex < 0 || firstIndex < 0)
+	{
+		// Out of room, double the buffers (or more for a very large mesh) and try again
+		if (baseVertex >= 0)
+			vertices.Free((size_t)baseVertex, vertexCount);
+		if (firstIndex >= 0)
+			indices.Free((size_t)firstIndex, indexCount);
+		size_t vertexCapacity = std::max(vertices.capacity * 2, vertices.capacity + vertexCount);
+		size_t indexCapacity = std::max(indices.capacity * 2, indices.capacity + indexCount);
+		Rebuild(vertexCapacity, indexCapacity, false);
+		baseVertex = vertices.Allocate(vertexCount);
+		firstIndex = indices.Allocate(indexCount);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)baseVertex * stride, (GLsizeiptr)vertexCount * stride, vertexData);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// Bind through the VAO so the element buffer binding of whatever VAO is bound is left alone
+	glBindVertexArray(VAO);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)firstIndex * sizeof(GLuint), (GLsizeiptr)indexCount * sizeof(GLuint), indexData);
+	glBindVertexArray(0);
+
+	Slot slot;
+	slot.mesh = { (GLint)baseVertex, (GLuint)firstIndex, indexCount, vertexCount };
+	slot.used = true;
+	MeshHandle handle;
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		meshes[handle] = slot;
+	}
+	else
+	{
+		handle = (MeshHandle)meshes.size();
+		meshes.push_back(slot);
+	}
+	return handle;
+}
+
+void BufferArena::Remove(MeshHandle handle) {
+	Slot& slot = meshes[handle];
+	if (!slot.used)
+		return;
+	vertices.Free((size_t)slot.mesh.baseVertex, slot.mesh.vertexCount);
+	indices.Free(slot.mesh.firstIndex, (size_t)slot.mesh.indexCount);
+	slot.used = false;
+	freeHandles.push_back(handle);
+}
+
+const ArenaMesh& BufferArena::Get(MeshHandle handle) {
+	return meshes[handle].mesh;
+}
+
+void BufferArena::Bind() {
+	glBindVertexArray(VAO);
+}
+
+void BufferArena::Unbind() {
+	glBindVertexArray(0);
+}
+
+void BufferArena::Draw(MeshHandle handle) {
+	const ArenaMesh& mesh = meshes[handle].mesh;
+	glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, (void*)(mesh.firstIndex * sizeof(GLuint)), mesh.baseVertex);
+}
+
+float BufferArena::Fragmentation() {
+	float worst = 0.0f;
+	RangeAllocator* allocators[] = { &vertices, &indices };
+	for (RangeAllocator* allocator : allocators)
+	{
+		size_t freeCount = allocator->FreeCount();
+		if (freeCount > 0)
+			worst = std::max(worst, 1.0f - (float)allocator->LargestFree() / (float)freeCount);
+	}
+	return worst;
+}
+
+void BufferArena::Defragment() {
+	Rebuild(vertices.capacity, indices.capacity, true);
+}
+
+void BufferArena::Rebuild(size_t vertexCapacity, size_t indexCapacity, bool compact) {
+	GLuint newVertexBuffer, newIndexBuffer;
+	glGenBuffers(1, &newVertexBuffer);
+	glGenBuffers(1, &newIndexBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * stride, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+
+	// The copies stay on the GPU, nothing comes back to the CPU
+	if (compact)
+	{
+		// Keep the meshes in their current order so the copy reads the old buffers front to back
+		std::vector<MeshHandle> order;
+		for (MeshHandle handle = 0; handle < meshes.size(); handle++)
+		{
+			if (meshes[handle].used)
+				order.push_back(handle);
+		}
+		std::sort(order.begin(), order.end(), [this](MeshHandle a, MeshHandle b) { return meshes[a].mesh.baseVertex < meshes[b].mesh.baseVertex; });
+
+		vertices = RangeAllocator(vertexCapacity);
+		indices = RangeAllocator(indexCapacity);
+		for (MeshHandle handle : order)
+		{
+			ArenaMesh& mesh = meshes[handle].mesh;
+			GLint baseVertex = (GLint)vertices.Allocate(mesh.vertexCount);
+			GLuint firstIndex = (GLuint)indices.Allocate((size_t)mesh.indexCount);
+			glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)mesh.baseVertex * stride, (GLintptr)baseVertex * stride, (GLsizeiptr)mesh.vertexCount * stride);
+			glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)mesh.firstIndex * sizeof(GLuint), (GLintptr)firstIndex * sizeof(GLuint), (GLsizeiptr)mesh.indexCount * sizeof(GLuint));
+			mesh.baseVertex = baseVertex;
+			mesh.firstIndex = firstIndex;
+		}
+	}
+	else
+	{
+		// Growing keeps every mesh where it is
+		glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)vertices.capacity * stride);
+		glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)indices.capacity * sizeof(GLuint));
+		vertices.Grow(vertexCapacity);
+		indices.Grow(indexCapacity);
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	vertexBuffer = newVertexBuffer;
+	indexBuffer = newIndexBuffer;
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBindVertexArray(0);
+	LinkAttribs();
+}
+
+void BufferArena::Delete() {
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+}
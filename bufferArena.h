@@ -0,0 +1,108 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<map>
+#include<vector>
+
+//Hands out ranges of a fixed sized space from a free list sorted by offset
+//Allocation is best fit, and freed ranges merge with free neighbours
+class RangeAllocator
+{
+public:
+	size_t capacity;
+
+	RangeAllocator(size_t capacity);
+
+	//Returns the offset of count free units, or -1 if no free range is large enough
+	long long Allocate(size_t count);
+	void Free(size_t offset, size_t count);
+	//Adds units to the end of the space
+	void Grow(size_t newCapacity);
+	//Units not allocated
+	size_t FreeCount();
+	//Size of the largest free range
+	size_t LargestFree();
+
+private:
+	//Free ranges, offset to size
+	std::map<size_t, size_t> freeRanges;
+};
+
+//Where one mesh lives inside the arena's buffers, ready for glDrawElementsBaseVertex
+struct ArenaMesh
+{
+	//Added to every index of the mesh, so indices stay relative to the mesh's own vertices
+	GLint baseVertex;
+	GLuint firstIndex;
+	GLsizei indexCount;
+	GLuint vertexCount;
+};
+
+//Identifies a mesh in an arena; unlike its ArenaMesh it does not change when the arena is defragmented
+typedef unsigned int MeshHandle;
+
+//Class stores many meshes in one vertex buffer and one index buffer sharing a single VAO,
+//so meshes can be drawn one after another with no buffer or VAO rebinds in between
+//All meshes in an arena use the same vertex layout. The buffers grow as needed, and
+//Defragment packs the meshes together again after many have been removed
+class BufferArena
+{
+public:
+	GLuint VAO;
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	GLsizei stride;
+
+	//Capacities are in vertices and indices
+	BufferArena(GLsizei stride, GLuint vertexCapacity, GLuint indexCapacity);
+
+	//Describes one vertex attribute, offset is in bytes from the start of a vertex
+	void LinkAttrib(GLuint layout, GLuint numComponents, GLenum type, size_t offset, GLboolean normalized = GL_FALSE);
+
+	//Copies a mesh into the arena; indices are relative to the mesh's first vertex
+	MeshHandle Add(const void* vertices, GLuint vertexCount, const GLuint* indices, GLsizei indexCount);
+	void Remove(MeshHandle handle);
+	//Current location of a mesh, valid until the next Add, Remove or Defragment
+	const ArenaMesh& Get(MeshHandle handle);
+
+	//Binds the VAO, call once before drawing any number of meshes
+	void Bind();
+	void Unbind();
+	//Draws a mesh, the arena must be bound
+	void Draw(MeshHandle handle);
+
+	//Fraction of the free space that is not part of the largest free range, for vertices or indices
+	float Fragmentation();
+	//Copies every mesh next to each other into new buffers, leaving all free space at the end
+	void Defragment();
+
+	void Delete();
+
+private:
+	struct Attrib
+	{
+		GLuint layout;
+		GLuint numComponents;
+		GLenum type;
+		size_t offset;
+		GLboolean normalized;
+	};
+	struct Slot
+	{
+		ArenaMesh mesh;
+		bool used;
+	};
+
+	std::vector<Attrib> attribs;
+	std::vector<Slot> meshes;
+	//Handles of removed meshes, reused by Add
+	std::vector<MeshHandle> freeHandles;
+	RangeAllocator vertices;
+	RangeAllocator indices;
+
+	//Replaces both buffers with new ones of the given capacities, packing the meshes at the start when compact is set
+	void Rebuild(size_t vertexCapacity, size_t indexCapacity, bool compact);
+	//Points the VAO's attributes at the current vertex buffer
+	void LinkAttribs();
+};
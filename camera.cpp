@@ -7,15 +7,30 @@ Camera::Camera(int width, int height, glm::vec3 position) {
 }
 
 void Camera::Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, const char* uniform)
+{
+	Matrix(FOVdeg, nearPlane, farPlane, shader, shader.Uniform(uniform));
+}
+
+void Camera::Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, GLint uniform)
 {
 	//Initialize our matrices
 	glm::mat4 view = glm::mat4(1.0f);
 	glm::mat4 projection = glm::mat4(1.0f);
 
 	view = glm::lookAt(Position, Position + Orientation, Up);
-	projection = glm::perspective(glm::radians(FOVdeg), (float)(width / height), nearPlane, farPlane);
+	projection = glm::perspective(glm::radians(FOVdeg), (float)width / (float)height, nearPlane, farPlane);
+	frustum = frustum_from_matrix(projection * view);
 	//Export our matrix to the vertex shader
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, uniform), 1, GL_FALSE, glm::value_ptr(projection * view));
+	shader.set(uniform, projection * view);
+}
+
+void Camera::Matrix(float FOVdeg, float nearPlane, float farPlane, FrameData& frame)
+{
+	frame.view = glm::lookAt(Position, Position + Orientation, Up);
+	frame.projection = glm::perspective(glm::radians(FOVdeg), (float)width / (float)height, nearPlane, farPlane);
+	frame.viewProj = frame.projection * frame.view;
+	frustum = frustum_from_matrix(frame.viewProj);
+	frame.camPos = Position;
 }
 void Camera::Inputs(GLFWwindow* window) 
 {
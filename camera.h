@@ -10,6 +10,8 @@
 
 
 #include "shaderClass.h"
+#include "UBO.h"
+#include "frustum.h"
 
 class Camera
 {
@@ -26,8 +28,15 @@ public:
 
 	bool firstClick = true;
 
+	//Planes of what the last Matrix call can see, in world space, for culling
+	Frustum frustum;
+
 	Camera(int width, int height, glm::vec3 position);
 
 	void Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, const char* uniform);
+	//Same as above with a handle from Shader::Uniform, which skips the name lookup
+	void Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, GLint uniform);
+	//Fills in the camera part of the shared per frame data instead of setting one program's uniform
+	void Matrix(float FOVdeg, float nearPlane, float farPlane, FrameData& frame);
 	void Inputs(GLFWwindow* window);
 };
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "commandBucket.h"
+
+#include<algorithm>
+
+unsigned long long draw_sort_key(unsigned int layer, GLuint program, GLuint texture, GLuint vao, float depth) {
+	unsigned long long quantized = (unsigned long long)(std::min(std::max(depth, 0.0f), 1.0f) * 0xFFFFF);
+	return ((unsigned long long)(layer & 0xF) << 60)
+		| ((unsigned long long)(program & 0xFFF) << 48)
+		| ((unsigned long long)(texture & 0xFFFF) << 32)
+		| ((unsigned long long)(vao & 0xFFF) << 20)
+		| quantized;
+}
+
+unsigned long long draw_sort_key(unsigned int layer, float depth, const DrawPacket& packet) {
+	GLuint texture = packet.atlas != NULL ? packet.atlas->ID : packet.texture != NULL ? packet.texture->ID : 0;
+	return draw_sort_key(layer, packet.shader->ID, texture, packet.vao->ID, depth);
+}
+
+float sort_depth(const glm::mat4& viewProj, const glm::vec3& position) {
+	glm::vec4 clip = viewProj * glm::vec4(position, 1.0f);
+	if (clip.w <= 0.0f)
+		return 0.0f;
+	return clip.z / clip.w * 0.5f + 0.5f;
+}
+
+void radix_sort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch) {
+	size_t count = entries.size();
+	// Nothing to sort, and the skip check below reads the first key
+	if (count == 0)
+		return;
+	scratch.resize(count);
+	// Count every digit in one pass over the keys
+	unsigned int histograms[8][256] = {};
+	for (const SortEntry& entry : entries)
+	{
+		for (int digit = 0; digit < 8; digit++)
+			histograms[digit][(entry.key >> (digit * 8)) & 0xFF]++;
+	}
+
+	for (int digit = 0; digit < 8; digit++)
+	{
+		unsigned int* histogram = histograms[digit];
+		// With all keys in one bucket this pass would not move anything
+		if (histogram[(entries[0].key >> (digit * 8)) & 0xFF] == count)
+			continue;
+		unsigned int offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			unsigned int n = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += n;
+		}
+		for (const SortEntry& entry : entries)
+			scratch[histogram[(entry.key >> (digit * 8)) & 0xFF]++] = entry;
+		// The sorted copy becomes the input of the next pass
+		entries.swap(scratch);
+	}
+}
+
+void CommandList::Submit(unsigned int layer, float depth, const DrawPacket& packet) {
+	Submit(draw_sort_key(layer, depth, packet), packet);
+}
+
+void CommandList::Submit(unsigned long long key, const DrawPacket& packet) {
+	keys.push_back(key);
+	packets.push_back(packet);
+	firstRanges.push_back(counts.size());
+	counts.insert(counts.end(), packet.counts, packet.counts + packet.drawCount);
+	offsets.insert(offsets.end(), packet.offsets, packet.offsets + packet.drawCount);
+}
+
+void CommandList::Clear() {
+	keys.clear();
+	packets.clear();
+	counts.clear();
+	offsets.clear();
+	firstRanges.clear();
+}
+
+CommandBucket::CommandBucket(TextureManager* textures) {
+	CommandBucket::textures = textures;
+}
+
+void CommandBucket::Submit(unsigned int layer, float depth, const DrawPacket& packet) {
+	Submit(draw_sort_key(layer, depth, packet), packet);
+}
+
+void CommandBucket::Submit(unsigned long long key, const DrawPacket& packet) {
+	SortEntry entry = { key, (unsigned int)packets.size() };
+	entries.push_back(entry);
+	packets.push_back(packet);
+	firstRanges.push_back(counts.size());
+	counts.insert(counts.end(), packet.counts, packet.counts + packet.drawCount);
+	offsets.insert(offsets.end(), packet.offsets, packet.offsets + packet.drawCount);
+}
+
+void CommandBucket::Append(const CommandList& list) {
+	size_t first = packets.size();
+	size_t firstRange = counts.size();
+	packets.insert(packets.end(), list.packets.begin(), list.packets.end());
+	counts.insert(counts.end(), list.counts.begin(), list.counts.end());
+	offsets.insert(offsets.end(), list.offsets.begin(), list.offsets.end());
+	for (size_t i = 0; i < list.keys.size(); i++)
+	{
+		SortEntry entry = { list.keys[i], (unsigned int)(first + i) };
+		entries.push_back(entry);
+		firstRanges.push_back(firstRange + list.firstRanges[i]);
+	}
+}
+
+void CommandBucket::Record(ThreadPool& pool, size_t count, size_t grain, const std::function<void(size_t, size_t, CommandList&)>& record) {
+	if (grain == 0)
+		grain = 1;
+	size_t chunks = (count + grain - 1) / grain;
+	if (lists.size() < chunks)
+		lists.resize(chunks);
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+		lists[chunk].Clear();
+	// Chunks start at multiples of grain, so each one knows its list without any locking
+	pool.ParallelFor(count, grain, [&](size_t begin, size_t end) {
+		record(begin, end, lists[begin / grain]);
+	});
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+		Append(lists[chunk]);
+}
+
+void CommandBucket::Flush() {
+	stats = CommandBucketStats();
+	if (entries.empty())
+		return;
+	radix_sort(entries, scratch);
+
+	// Anything may have been bound since the last flush, so the first draw binds everything
+	Shader* shader = NULL;
+	// Textures and atlases both count as the bound image
+	const void* image = NULL;
+	VAO* vao = NULL;
+	for (const SortEntry& entry : entries)
+	{
+		const DrawPacket& packet = packets[entry.packet];
+		if (packet.shader != shader)
+		{
+			shader = packet.shader;
+			shader->Activate();
+			stats.programChanges++;
+		}
+		if (packet.atlas != NULL && packet.atlas != image)
+		{
+			image = packet.atlas;
+			glActiveTexture(packet.atlas->slot);
+			packet.atlas->Bind();
+			stats.textureChanges++;
+		}
+		else if (packet.atlas == NULL && packet.texture != NULL && packet.texture != image)
+		{
+			image = packet.texture;
+			glActiveTexture(packet.texture->slot);
+			if (textures != NULL)
+				textures->Bind(*packet.texture);
+			else
+				packet.texture->Bind();
+			stats.textureChanges++;
+		}
+		if (packet.vao != vao)
+		{
+			vao = packet.vao;
+			vao->Bind();
+			stats.vaoChanges++;
+		}
+
+		// The ranges were copied at submit, draw from the copies
+		if (packet.drawCount > 0)
+			glMultiDrawElements(packet.mode, &counts[firstRanges[entry.packet]], packet.indexType, &offsets[firstRanges[entry.packet]], packet.drawCount);
+		else if (packet.baseVertex != 0)
+			glDrawElementsBaseVertex(packet.mode, packet.count, packet.indexType, (void*)packet.indices, packet.baseVertex);
+		else
+			glDrawElements(packet.mode, packet.count, packet.indexType, packet.indices);
+		stats.draws++;
+	}
+	packets.clear();
+	entries.clear();
+	counts.clear();
+	offsets.clear();
+	firstRanges.clear();
+}
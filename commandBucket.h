@@ -0,0 +1,124 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<functional>
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "shaderClass.h"
+#include "texture.h"
+#include "textureAtlas.h"
+#include "VAO.h"
+#include "textureManager.h"
+#include "threadPool.h"
+
+//Everything needed to issue one draw, so draws can be queued and issued later in any order
+//The pointed to objects must stay valid until the bucket is flushed; the counts and offsets
+//arrays are copied when the packet is submitted, so they can be reused right after
+struct DrawPacket
+{
+	Shader* shader = NULL;
+	//NULL to draw without a texture
+	Texture* texture = NULL;
+	//Bound instead of texture when set, for draws using the ATLAS shader variant
+	TextureAtlas* atlas = NULL;
+	VAO* vao = NULL;
+	GLenum mode = GL_TRIANGLES;
+	GLenum indexType = GL_UNSIGNED_INT;
+	//A single indexed draw of count indices starting at byte offset indices
+	GLsizei count = 0;
+	const void* indices = NULL;
+	GLint baseVertex = 0;
+	//Several ranges of the same buffers in one glMultiDrawElements when drawCount is above 0
+	const GLsizei* counts = NULL;
+	const void* const* offsets = NULL;
+	GLsizei drawCount = 0;
+};
+
+//Draw order key, compared as one 64 bit number so sorting groups draws that share state
+//From the top: layer 4 bits, program 12, texture 16, VAO 12, depth 20
+//Programs, textures and VAOs are keyed by their OpenGL names; names past a field's width
+//wrap around, which only makes grouping less tight since replay compares the real objects
+unsigned long long draw_sort_key(unsigned int layer, GLuint program, GLuint texture, GLuint vao, float depth);
+//Key for a packet from its shader, texture and VAO names
+unsigned long long draw_sort_key(unsigned int layer, float depth, const DrawPacket& packet);
+//Depth of a point from 0 at the near plane to 1 at the far plane, for draw_sort_key
+float sort_depth(const glm::mat4& viewProj, const glm::vec3& position);
+
+//A queued draw's key and the index of its packet
+struct SortEntry
+{
+	unsigned long long key;
+	unsigned int packet;
+};
+
+//Sorts entries by key with 8 bit digits, keeping equal keys in submission order
+//Digits every key shares are skipped; scratch is resized as needed
+void radix_sort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+//Counters from the last flush
+struct CommandBucketStats
+{
+	unsigned int draws = 0;
+	unsigned int programChanges = 0;
+	unsigned int textureChanges = 0;
+	unsigned int vaoChanges = 0;
+};
+
+//Class holds draws recorded by one job, to be handed to a CommandBucket on the GL thread
+//Recording makes no OpenGL calls and touches nothing shared, so jobs each fill their own list without locking
+class CommandList
+{
+public:
+	//Same as CommandBucket::Submit
+	void Submit(unsigned int layer, float depth, const DrawPacket& packet);
+	void Submit(unsigned long long key, const DrawPacket& packet);
+	void Clear();
+	size_t Size() { return keys.size(); }
+
+private:
+	friend class CommandBucket;
+	std::vector<unsigned long long> keys;
+	std::vector<DrawPacket> packets;
+	//Copies of the packets' ranges, and where each packet's first range is in them
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<size_t> firstRanges;
+};
+
+//Class collects a frame's draws and issues them sorted by key, binding only state that changes
+class CommandBucket
+{
+public:
+	CommandBucketStats stats;
+
+	//With a texture manager, textures are bound through it so it can track their use
+	CommandBucket(TextureManager* textures = NULL);
+
+	//Queues a draw; layers are drawn in increasing order and draws in a layer front to back
+	//by depth, pass 1 - depth for layers that have to be drawn back to front
+	void Submit(unsigned int layer, float depth, const DrawPacket& packet);
+	//Queues a draw with a key built elsewhere
+	void Submit(unsigned long long key, const DrawPacket& packet);
+	//Queues every draw of a list recorded elsewhere, call on the thread that flushes
+	void Append(const CommandList& list);
+	//Splits [0, count) into chunks of grain items and runs record(begin, end, list) on the pool,
+	//each chunk into its own list, then appends the lists in chunk order so the result does not
+	//depend on which thread finished first; record must not make OpenGL calls
+	void Record(ThreadPool& pool, size_t count, size_t grain, const std::function<void(size_t, size_t, CommandList&)>& record);
+	//Sorts the queued draws, issues them and empties the bucket
+	void Flush();
+	size_t Size() { return entries.size(); }
+
+private:
+	TextureManager* textures;
+	std::vector<DrawPacket> packets;
+	//Copies of the packets' ranges, and where each packet's first range is in them
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<size_t> firstRanges;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	//Kept between frames so recording reuses their memory
+	std::vector<CommandList> lists;
+};
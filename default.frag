@@ -6,10 +6,39 @@ in vec3 color;
 
 in vec2 texCoord;
 
+#ifdef ATLAS
+// Many images packed into the pages of one array texture (TextureAtlas)
+uniform sampler2DArray tex0;
+flat in float layer;
+#else
 uniform sampler2D tex0;
+#endif
+
+#ifdef FOG
+in float viewDepth;
+
+uniform vec3 fogColor;
+uniform float fogDensity;
+#endif
 
 void main()
 {
-   //FragColor = vec4(color, 1.0f);
+   // Without any variant defines the shader samples the texture, as it always has
+#if defined(VERTEX_COLOR) && !defined(TEXTURE)
+   FragColor = vec4(color, 1.0f);
+#else
+#ifdef ATLAS
+   FragColor = texture(tex0, vec3(texCoord, layer));
+#else
    FragColor = texture(tex0, texCoord);
+#endif
+#ifdef VERTEX_COLOR
+   FragColor *= vec4(color, 1.0f);
+#endif
+#endif
+#ifdef FOG
+   // Exponential fog, 1 near the camera falling towards 0 in the distance
+   float visibility = clamp(exp(-fogDensity * viewDepth), 0.0f, 1.0f);
+   FragColor.rgb = mix(fogColor, FragColor.rgb, visibility);
+#endif
 }
\ No newline at end of file
@@ -2,18 +2,58 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec2 aTex;
+#ifdef INSTANCING
+// Per instance offset, advanced once per instance with glVertexAttribDivisor
+layout (location = 3) in vec3 aOffset;
+#endif
+#ifdef ATLAS
+// Atlas page the texture coordinates point into, written by remap_uvs
+layout (location = 5) in float aLayer;
+flat out float layer;
+#endif
 
 out vec3 color;
 
 out vec2 texCoord;
 
-uniform mat4 camMatrix;
+#ifdef PACKED_VERTICES
+#include "packedVertex.glsl"
+#endif
+
+#ifdef FOG
+// Distance from the camera, used by the fragment shader to fade into the fog
+out float viewDepth;
+#endif
+
+// Per frame data shared by every program, bound to FRAME_DATA_BINDING by Shader
+layout (std140) uniform FrameData
+{
+   mat4 view;
+   mat4 projection;
+   mat4 viewProj;
+   vec3 camPos;
+   float time;
+};
 
 void main()
 {
+#ifdef PACKED_VERTICES
+   vec3 position = decodePosition(aPos);
+#else
+   vec3 position = aPos;
+#endif
+#ifdef INSTANCING
+   position += aOffset;
+#endif
    // Outputs the positions/coordinates of all vertices
-   gl_Position = camMatrix * vec4(aPos, 1.0);
+   gl_Position = viewProj * vec4(position, 1.0);
    // Assigns the colors from the Vertex Data to "color"
    color = aColor;
    texCoord = aTex;
+#ifdef ATLAS
+   layer = aLayer;
+#endif
+#ifdef FOG
+   viewDepth = gl_Position.w;
+#endif
 }
\ No newline at end of file
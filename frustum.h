@@ -0,0 +1,16 @@
+#pragma once
+
+#include<glm/glm/glm.hpp>
+
+//The six planes bounding what a camera sees, as (normal, distance) with normals pointing inwards
+//A point p is inside a plane when dot(normal, p) + distance >= 0
+struct Frustum
+{
+	//Left, right, bottom, top, near, far
+	glm::vec4 planes[6];
+};
+
+//Extracts the planes from a projection * view matrix (Gribb and Hartmann), normalized so
+//plane distances are in world units and spheres can be tested against them
+//With a projection * view * model matrix the planes come out in model space instead
+Frustum frustum_from_matrix(const glm::mat4& viewProj);
@@ -0,0 +1,47 @@
+#include "glExtensions.h"
+
+#include<GLFW/glfw3.h>
+#include<cstring>
+
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = NULL;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
+
+GLExtensions gl_extensions;
+
+void load_gl_extensions() {
+	gl_extensions.textureCompressionS3TC = has_gl_extension("GL_EXT_texture_compression_s3tc");
+
+	// An extension only counts as supported if its functions could be loaded too
+	glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+	gl_extensions.bufferStorage = has_gl_extension("GL_ARB_buffer_storage") && glad_glBufferStorage != NULL;
+
+	glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)glfwGetProcAddress("glGetProgramBinary");
+	glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)glfwGetProcAddress("glProgramBinary");
+	glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)glfwGetProcAddress("glProgramParameteri");
+	GLint binaryFormats = 0;
+	if (has_gl_extension("GL_ARB_get_program_binary"))
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+	gl_extensions.programBinary = binaryFormats > 0 && glad_glGetProgramBinary != NULL && glad_glProgramBinary != NULL && glad_glProgramParameteri != NULL;
+
+	// Some drivers only expose the ARB version, which behaves the same
+	if (has_gl_extension("GL_KHR_parallel_shader_compile"))
+		glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+	else if (has_gl_extension("GL_ARB_parallel_shader_compile"))
+		glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+	gl_extensions.parallelShaderCompile = glad_glMaxShaderCompilerThreadsKHR != NULL;
+}
+
+bool has_gl_extension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != NULL && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include<cstddef>
+#include<cstring>
+
+//64 bit FNV-1a, used to name cache files and key lookup tables
+//Pass the previous result as hash to continue hashing over several pieces
+inline unsigned long long hash_bytes(const void* data, size_t size, unsigned long long hash = 1469598103934665603ULL) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+inline unsigned long long hash_string(const char* text, unsigned long long hash = 1469598103934665603ULL) {
+	return hash_bytes(text, strlen(text), hash);
+}
@@ -0,0 +1,179 @@
+#include "ktxFile.h"
+
+#include<cstdio>
+#include<cstring>
+
+static const unsigned char ktxIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+//Vulkan format numbers KTX2 uses to name its contents
+static const unsigned int VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+static const unsigned int VK_FORMAT_BC3_UNORM_BLOCK = 137;
+
+//Byte offsets of the header fields, all little endian
+static const size_t headerSize = 80;
+static const size_t levelIndexEntry = 24;
+
+static unsigned int readU32(const unsigned char* p) {
+	return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+static unsigned long long readU64(const unsigned char* p) {
+	return (unsigned long long)readU32(p) | (unsigned long long)readU32(p + 4) << 32;
+}
+
+static void writeU32(std::vector<unsigned char>& out, size_t at, unsigned int v) {
+	for (int i = 0; i < 4; i++)
+		out[at + i] = (unsigned char)(v >> (i * 8));
+}
+
+static void writeU64(std::vector<unsigned char>& out, size_t at, unsigned long long v) {
+	writeU32(out, at, (unsigned int)v);
+	writeU32(out, at + 4, (unsigned int)(v >> 32));
+}
+
+//Block compressed formats are 4x4 texels per block
+static size_t levelSize(GLenum internalFormat, int width, int height) {
+	size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+	return blocks * (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16);
+}
+
+bool KtxFile::Open(const char* filename) {
+	Close();
+	if (!file.Open(filename))
+		return false;
+	const unsigned char* p = file.data;
+	if (file.size < headerSize || memcmp(p, ktxIdentifier, sizeof(ktxIdentifier)) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	unsigned int vkFormat = readU32(p + 12);
+	if (vkFormat == VK_FORMAT_BC1_RGB_UNORM_BLOCK)
+		internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	else if (vkFormat == VK_FORMAT_BC3_UNORM_BLOCK)
+		internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	else
+	{
+		Close();
+		return false;
+	}
+	width = (int)readU32(p + 20);
+	height = (int)readU32(p + 24);
+	unsigned int levelCount = readU32(p + 40);
+	unsigned int supercompression = readU32(p + 44);
+	if (width <= 0 || height <= 0 || levelCount == 0 || supercompression != 0 || file.size < headerSize + levelCount * levelIndexEntry)
+	{
+		Close();
+		return false;
+	}
+
+	for (unsigned int i = 0; i < levelCount; i++)
+	{
+		const unsigned char* entry = p + headerSize + i * levelIndexEntry;
+		unsigned long long offset = readU64(entry);
+		unsigned long long length = readU64(entry + 8);
+		KtxLevel level;
+		level.width = width >> i > 0 ? width >> i : 1;
+		level.height = height >> i > 0 ? height >> i : 1;
+		level.data = p + offset;
+		level.size = (size_t)length;
+		// Reject truncated files instead of letting OpenGL read past the mapping
+		if (offset + length > file.size || length != levelSize(internalFormat, level.width, level.height))
+		{
+			Close();
+			return false;
+		}
+		levels.push_back(level);
+	}
+	return true;
+}
+
+void KtxFile::Close() {
+	file.Close();
+	levels.clear();
+	internalFormat = 0;
+	width = 0;
+	height = 0;
+}
+
+size_t KtxFile::Size() const {
+	size_t total = 0;
+	for (const KtxLevel& level : levels)
+		total += level.size;
+	return total;
+}
+
+bool KtxFile::Write(const char* filename, GLenum internalFormat, int width, int height, const std::vector<std::vector<unsigned char>>& levels) {
+	bool bc1 = internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	unsigned int numSamples = bc1 ? 1 : 2;
+
+	// Data Format Descriptor: total size followed by one basic descriptor block
+	size_t dfdOffset = headerSize + levels.size() * levelIndexEntry;
+	size_t dfdLength = 4 + 24 + 16 * numSamples;
+	std::vector<unsigned char> out(dfdOffset + dfdLength, 0);
+
+	memcpy(out.data(), ktxIdentifier, sizeof(ktxIdentifier));
+	writeU32(out, 12, bc1 ? VK_FORMAT_BC1_RGB_UNORM_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK);
+	writeU32(out, 16, 1); // typeSize is 1 for block compressed formats
+	writeU32(out, 20, (unsigned int)width);
+	writeU32(out, 24, (unsigned int)height);
+	writeU32(out, 28, 0); // pixelDepth, 0 for 2D
+	writeU32(out, 32, 0); // layerCount, 0 for not an array
+	writeU32(out, 36, 1); // faceCount
+	writeU32(out, 40, (unsigned int)levels.size());
+	writeU32(out, 44, 0); // no supercompression
+	writeU32(out, 48, (unsigned int)dfdOffset);
+	writeU32(out, 52, (unsigned int)dfdLength);
+	// No key/value or supercompression global data, so their offsets and lengths stay 0
+
+	size_t dfd = dfdOffset;
+	writeU32(out, dfd, (unsigned int)dfdLength);
+	writeU32(out, dfd + 4, 0); // vendor 0 (Khronos), descriptor type 0 (basic)
+	writeU32(out, dfd + 8, 2 | (24 + 16 * numSamples) << 16); // version 2 and block size
+	// Color model BC1A (128) or BC3 (130), BT.709 primaries, linear transfer, straight alpha
+	out[dfd + 12] = bc1 ? 128 : 130;
+	out[dfd + 13] = 1;
+	out[dfd + 14] = 1;
+	out[dfd + 15] = 0;
+	// Texel block is 4x4x1x1, stored as size - 1
+	out[dfd + 16] = 3;
+	out[dfd + 17] = 3;
+	out[dfd + 20] = bc1 ? 8 : 16; // bytes per block in plane 0
+	size_t sample = dfd + 28;
+	if (!bc1)
+	{
+		// BC3 alpha is the first 64 bits of each block
+		writeU32(out, sample, 0 | 63 << 16 | 15 << 24);
+		writeU32(out, sample + 12, 0xFFFFFFFF);
+		sample += 16;
+	}
+	writeU32(out, sample, (bc1 ? 0 : 64) | 63 << 16 | 0 << 24);
+	writeU32(out, sample + 12, 0xFFFFFFFF);
+
+	// Level data is stored smallest first, each level aligned to the 8 or 16 byte block size
+	for (size_t i = levels.size(); i-- > 0;)
+	{
+		while (out.size() % 16 != 0)
+			out.push_back(0);
+		writeU64(out, headerSize + i * levelIndexEntry, out.size());
+		writeU64(out, headerSize + i * levelIndexEntry + 8, levels[i].size());
+		writeU64(out, headerSize + i * levelIndexEntry + 16, levels[i].size());
+		out.insert(out.end(), levels[i].begin(), levels[i].end());
+	}
+
+	// Write to a temporary name first so a crash never leaves a half written cache entry behind
+	std::string temporary = std::string(filename) + ".tmp";
+	FILE* f = fopen(temporary.c_str(), "wb");
+	if (f == NULL)
+		return false;
+	bool written = fwrite(out.data(), 1, out.size(), f) == out.size();
+	fclose(f);
+	remove(filename);
+	if (!written || rename(temporary.c_str(), filename) != 0)
+	{
+		remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
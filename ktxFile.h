@@ -0,0 +1,41 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<vector>
+
+#include "glExtensions.h"
+#include "mappedFile.h"
+
+//One mip level inside a mapped KTX2 file
+struct KtxLevel
+{
+	int width;
+	int height;
+	const unsigned char* data;
+	size_t size;
+};
+
+//Class reads and writes the subset of KTX2 we use for the texture cache:
+//2D, one layer, one face, no supercompression, BC1 or BC3 data with a full mip chain
+class KtxFile
+{
+public:
+	GLenum internalFormat = 0;
+	int width = 0;
+	int height = 0;
+	//Level 0 is the full size image
+	std::vector<KtxLevel> levels;
+
+	//Maps a file and points levels at its data, returning false if it is missing or not one of ours
+	bool Open(const char* filename);
+	//Unmaps the file; levels are no longer valid afterwards
+	void Close();
+	//Bytes of texel data over all levels
+	size_t Size() const;
+
+	//Writes a file; levels[0] is the full size image
+	static bool Write(const char* filename, GLenum internalFormat, int width, int height, const std::vector<std::vector<unsigned char>>& levels);
+
+private:
+	MappedFile file;
+};
@@ -13,17 +13,42 @@
 #include "EBO.h"
 #include "texture.h"
 #include "camera.h"
+#include "threadPool.h"
+#include "textureLoader.h"
+#include "textureCache.h"
+#include "textureManager.h"
+#include "tools.h"
+#include "glExtensions.h"
+#include "shaderWatcher.h"
+#include "shaderVariants.h"
+#include "UBO.h"
+#include "vertexLayout.h"
+#include "meshPacking.h"
+#include "meshOptimizer.h"
+#include "meshlets.h"
+#include "boundsCulling.h"
+#include "occlusionCulling.h"
+#include "commandBucket.h"
+#include "textureAtlas.h"
 
 const unsigned int width = 800;
 const unsigned int height = 800;
 
-GLfloat vertices[] =
-{ //     COORDINATES     /        COLORS      /   TexCoord  //
-	-0.5f,	0.0f,  0.5f,     0.83f, 0.70f, 0.44f,	0.0f, 0.0f,
-	-0.5f,  0.0f, -0.5f,     0.83f, 0.70f, 0.44f,	5.0f, 0.0f,
-	 0.5f,  0.0f, -0.5f,     0.83f, 0.70f, 0.44f,	0.0f, 0.0f,
-	 0.5f,  0.0f,  0.5f,     0.83f, 0.70f, 0.44f,	5.0f, 0.0f,
-	 0.0f,  0.8f,  0.0f,     0.92f, 0.86f, 0.76f,	2.5f, 5.0f
+//One vertex of the pyramid
+struct Vertex
+{
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 texCoord;
+};
+
+Vertex vertices[] =
+{ //     COORDINATES           /        COLORS           /   TexCoord  //
+	{ { -0.5f, 0.0f,  0.5f },     { 0.83f, 0.70f, 0.44f },	{ 0.0f, 0.0f } },
+	{ { -0.5f, 0.0f, -0.5f },     { 0.83f, 0.70f, 0.44f },	{ 5.0f, 0.0f } },
+	{ {  0.5f, 0.0f, -0.5f },     { 0.83f, 0.70f, 0.44f },	{ 0.0f, 0.0f } },
+	{ {  0.5f, 0.0f,  0.5f },     { 0.83f, 0.70f, 0.44f },	{ 5.0f, 0.0f } },
+	{ {  0.0f, 0.8f,  0.0f },     { 0.92f, 0.86f, 0.76f },	{ 2.5f, 5.0f } }
 };
 
 GLuint indices[] =
@@ -36,9 +61,69 @@ GLuint indices[] =
 	3, 0, 4
 };
 
+//One vertex of the wall, whose texture coordinates point into an atlas page
+struct AtlasVertex
+{
+	glm::vec3 position;
+	glm::vec2 texCoord;
+	float layer;
+};
+
+using AtlasVertexLayout = VertexLayout<AtlasVertex,
+	VERTEX_ATTRIB(0, Float3, AtlasVertex, position),
+	VERTEX_ATTRIB(2, Float2, AtlasVertex, texCoord),
+	VERTEX_ATTRIB(5, Float1, AtlasVertex, layer)>;
+
+//Two panels behind the pyramid, each showing its own image; remap_uvs fills in the atlas coordinates
+AtlasVertex wallVertices[] =
+{ //     COORDINATES           /   TexCoord   / Layer //
+	{ { -1.5f, -0.5f, -1.5f },	{ 0.0f, 0.0f },	0.0f },
+	{ {  0.0f, -0.5f, -1.5f },	{ 1.0f, 0.0f },	0.0f },
+	{ {  0.0f,  1.5f, -1.5f },	{ 1.0f, 1.0f },	0.0f },
+	{ { -1.5f,  1.5f, -1.5f },	{ 0.0f, 1.0f },	0.0f },
+	{ {  0.0f, -0.5f, -1.5f },	{ 0.0f, 0.0f },	0.0f },
+	{ {  1.5f, -0.5f, -1.5f },	{ 1.0f, 0.0f },	0.0f },
+	{ {  1.5f,  1.5f, -1.5f },	{ 1.0f, 1.0f },	0.0f },
+	{ {  0.0f,  1.5f, -1.5f },	{ 0.0f, 1.0f },	0.0f }
+};
 
-int main() 
+GLuint wallIndices[] =
 {
+	0, 1, 2,
+	0, 2, 3,
+	4, 5, 6,
+	4, 6, 7
+};
+
+//Makes a size x size RGBA checkerboard of cells x cells squares, freed with TextureImage::Free
+static TextureImage checker_image(int size, int cells, glm::u8vec3 a, glm::u8vec3 b) {
+	TextureImage image;
+	image.width = size;
+	image.height = size;
+	image.numColCh = 4;
+	image.bytes = (unsigned char*)malloc(image.Size());
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			glm::u8vec3 color = ((x * cells / size) + (y * cells / size)) % 2 == 0 ? a : b;
+			unsigned char* texel = image.bytes + ((size_t)y * size + x) * 4;
+			texel[0] = color.r;
+			texel[1] = color.g;
+			texel[2] = color.b;
+			texel[3] = 255;
+		}
+	}
+	return image;
+}
+
+
+int main(int argc, char** argv)
+{
+	//Command line tools run without a window
+	if (argc > 1)
+		return run_tool(argc, argv);
+
 	glfwInit();
 
 	//Tell GLFW what version of OpenGL we are using
@@ -65,6 +150,8 @@ int main()
 
 	//Load GLAD so it configures OpenGL
 	gladLoadGL();
+	//Load the optional extensions glad does not know about
+	load_gl_extensions();
 
 	//Specify the viewport of OpenGL in the window
 	// Viewport goes from 0,0 (lower left) to 800, 800 (upper right)
@@ -73,21 +160,50 @@ int main()
 	//Create shaders and buffers
 	//==========================
 	//Create Shader object using default shaders
-	Shader shaderProgram("default.vert", "default.frag");
+	//Linked programs are kept in a binary cache so later runs skip compiling
+	ProgramCache programCache("cache/shaders");
+	//Programs that are not cached yet are compiled in parallel
+	ShaderCompiler shaderCompiler(window);
+	ShaderVariants shaders("default.vert", "default.frag", &programCache, &shaderCompiler);
+	//Build the variants the scene will need before the first frame
+	shaders.Prewarm<ShaderFeature::Texture | ShaderFeature::PackedVertices, ShaderFeature::Texture | ShaderFeature::Atlas, ShaderFeature::Texture, ShaderFeature::VertexColor, ShaderFeature::Texture | ShaderFeature::Fog>();
+	Shader& shaderProgram = shaders.Get<ShaderFeature::Texture | ShaderFeature::PackedVertices>();
+#ifdef _DEBUG
+	//Reload the shaders whenever their files are saved
+	ShaderWatcher shaderWatcher;
+	shaderWatcher.Watch(shaders);
+#endif
 
 	//Generate Vertex Array object and bind it
 	VAO VAO1;
 	VAO1.Bind();
 
+	//Reorder the triangles for the vertex cache and early depth rejection, then the vertices to match
+	size_t vertexCount = sizeof(vertices) / sizeof(Vertex);
+	const size_t indexCount = sizeof(indices) / sizeof(GLuint);
+	optimize_vertex_cache(indices, indexCount, vertexCount);
+	optimize_overdraw(indices, indexCount, &vertices[0].position, vertexCount, sizeof(Vertex));
+	vertexCount = optimize_vertex_fetch(vertices, vertexCount, sizeof(Vertex), indices, indexCount);
+
+	//Split the triangles into meshlets that can be culled on their own
+	MeshletMesh pyramidMeshlets = build_meshlets(indices, indexCount, &vertices[0].position, vertexCount, sizeof(Vertex));
+	MeshletCuller meshletCuller(pyramidMeshlets);
+
+	//Quantize the vertices so each takes 16 bytes instead of 32
+	PackedMesh pyramid = pack_mesh(vertexCount, &vertices[0].position, &vertices[0].color, &vertices[0].texCoord, NULL, sizeof(Vertex));
+	std::cout << "MESH_PACKED pyramid: " << pyramid.unpackedBytes << " -> " << pyramid.Bytes() << " bytes, max error position "
+		<< pyramid.errors.position << " color " << pyramid.errors.color << " uv " << pyramid.errors.texCoord << std::endl;
+	//The shader places the packed positions inside the mesh's bounding box
+	shaderProgram.set("meshMin", pyramid.boundsMin);
+	shaderProgram.set("meshSize", pyramid.boundsSize);
+
 	//Generate Vertex Buffer object and link it to vertices
-	VBO VBO1(vertices, sizeof(vertices));
-	//Generate Element Buffer and link it to indices
-	EBO EBO1(indices, sizeof(indices));
+	VBO VBO1(pyramid.Data(), pyramid.Bytes());
+	//Generate Element Buffer and link it to the meshlets' indices
+	EBO EBO1(pyramidMeshlets.indices.data(), pyramidMeshlets.indices.size() * sizeof(GLuint));
 
 	//Link VBO to VAO
-	VAO1.LinkAttrib(VBO1, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
-	VAO1.LinkAttrib(VBO1, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	VAO1.LinkAttrib(VBO1, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	PackedVertexLayout::Link(VAO1, VBO1);
 
 	//unbind all to prevent accidentally modifying any of them
 	VAO1.Unbind();
@@ -95,15 +211,68 @@ int main()
 	EBO1.Unbind();
 
 	//Texture
+	//Decoding runs on worker threads and the texture shows a placeholder until it is ready
+	ThreadPool workers;
+	//Images cooked with --cook are loaded compressed from here
+	TextureCache textureCache("cache/textures");
+	//Upload at most 16MB of texels per frame
+	TextureLoader textureLoader(workers, 16 * 1024 * 1024, &textureCache);
+	//Keep textures within 256MB, evicting the least recently used ones beyond that
+	TextureManager textures(textureLoader, 256 * 1024 * 1024);
 	std::string pStr{ "resources/pots2k2k.png" };
-	Texture pots(pStr.c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+	Texture& pots = textures.Load(pStr.c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
 	pots.texUnit(shaderProgram, "tex0", 0);
 
+	//Both wall images share one atlas, so the whole wall is drawn with a single bind
+	std::vector<TextureImage> wallImages = { checker_image(256, 8, glm::u8vec3(200, 60, 50), glm::u8vec3(240, 220, 200)), checker_image(256, 2, glm::u8vec3(40, 90, 160), glm::u8vec3(220, 230, 240)) };
+	TextureAtlas wallAtlas(wallImages, 512, 4, 5, GL_TEXTURE1);
+	for (TextureImage& image : wallImages)
+		image.Free();
+	const int atlasStride = sizeof(AtlasVertex) / sizeof(GLfloat);
+	remap_uvs(&wallVertices[0].position.x, 4, atlasStride, 3, 5, wallAtlas.regions[0]);
+	remap_uvs(&wallVertices[4].position.x, 4, atlasStride, 3, 5, wallAtlas.regions[1]);
+	Shader& atlasProgram = shaders.Get<ShaderFeature::Texture | ShaderFeature::Atlas>();
+	wallAtlas.texUnit(atlasProgram, "tex0", 1);
+
+	VAO wallVAO;
+	wallVAO.Bind();
+	VBO wallVBO(wallVertices, sizeof(wallVertices));
+	EBO wallEBO(wallIndices, sizeof(wallIndices));
+	AtlasVertexLayout::Link(wallVAO, wallVBO);
+	wallVAO.Unbind();
+	wallVBO.Unbind();
+	wallEBO.Unbind();
+
 	//Enables the depth buffer
 	//Needed for discerning front vs back faces
 	glEnable(GL_DEPTH_TEST);
 
 	Camera camera(width, height, glm::vec3(0.0f, 0.0f, 2.0f));
+	//Camera matrices and time go to every program through one uniform buffer
+	UBO frameUniforms(FRAME_DATA_BINDING, sizeof(FrameData));
+	FrameData frame;
+	//Bounds of every object in the scene, tested against the camera before anything is drawn
+	BoundsCuller sceneBounds;
+	unsigned int pyramidBounds = sceneBounds.AddBox(pyramid.boundsMin, pyramid.boundsMin + pyramid.boundsSize);
+	unsigned int wallBounds = sceneBounds.AddBox(glm::vec3(-1.5f, -0.5f, -1.5f), glm::vec3(1.5f, 1.5f, -1.5f));
+	std::vector<unsigned int> visibleObjects;
+	//Big meshes are drawn into a small CPU depth buffer so objects hidden behind them can be skipped
+	//The wall is the only occluder, so only the other objects are tested against it
+	OcclusionCuller occlusion;
+	//Draws are queued with a sort key and issued together, binding only the state that changes
+	CommandBucket renderQueue(&textures);
+	DrawPacket pyramidDraw;
+	pyramidDraw.shader = &shaderProgram;
+	pyramidDraw.texture = &pots;
+	pyramidDraw.vao = &VAO1;
+	//The EBO picked the smallest index type that fits, draw with that
+	pyramidDraw.indexType = EBO1.type;
+	DrawPacket wallDraw;
+	wallDraw.shader = &atlasProgram;
+	wallDraw.atlas = &wallAtlas;
+	wallDraw.vao = &wallVAO;
+	wallDraw.indexType = wallEBO.type;
+	wallDraw.count = wallEBO.count;
 
 	while (!glfwWindowShouldClose(window)) {
 		//Draw a fresh background
@@ -113,24 +282,66 @@ int main()
 		//Also clear the GL depth buffer so a new depth set is calculated
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		//Hand any finished texture decodes to OpenGL
+		textureLoader.Update();
+		//Make any prewarmed shaders that finished compiling ready
+		shaderCompiler.Update();
+#ifdef _DEBUG
+		shaderWatcher.Update();
+#endif
+
 		//Draw our shapes
 		//===============
-		//Activate the shader program
-		shaderProgram.Activate();
-
 		camera.Inputs(window);
-		camera.Matrix(45.0f, 0.1f, 100.0f, shaderProgram, "camMatrix");
-
-		// Binds texture so that it appears in rendering
-		pots.Bind();
+		camera.Matrix(45.0f, 0.1f, 100.0f, frame);
+		frame.time = (float)glfwGetTime();
+		frameUniforms.Update(&frame);
 
-		//Bind the VAO so OpenGL knows to use this one
-		//Not strictly needed as we only have one object but it is good practice so OpenGL knows which vao to use
-		VAO1.Bind();
-		glDrawElements(GL_TRIANGLES, sizeof(indices)/sizeof(int), GL_UNSIGNED_INT, 0);
+		//Draw the occluders on the CPU, then skip objects that are off screen or hidden behind them
+		occlusion.Begin(frame.viewProj);
+		occlusion.AddOccluder(&wallVertices[0].position, sizeof(AtlasVertex), wallIndices, sizeof(wallIndices) / sizeof(GLuint));
+		occlusion.Rasterize(&workers);
+		sceneBounds.Cull(camera.frustum, visibleObjects);
+		//Cull and record the visible objects' draws on the workers, only the flush below touches OpenGL
+		renderQueue.Record(workers, visibleObjects.size(), 1, [&](size_t begin, size_t end, CommandList& list) {
+			//The pyramid's meshlets left after culling and where each one's indices start, the list copies them at submit
+			std::vector<unsigned int> visibleMeshlets;
+			std::vector<GLsizei> meshletCounts;
+			std::vector<const void*> meshletOffsets;
+			for (size_t i = begin; i < end; i++)
+			{
+				if (visibleObjects[i] == wallBounds)
+				{
+					list.Submit(0, sort_depth(frame.viewProj, glm::vec3(0.0f, 0.5f, -1.5f)), wallDraw);
+					continue;
+				}
+				if (visibleObjects[i] != pyramidBounds || !occlusion.TestBox(pyramid.boundsMin, pyramid.boundsMin + pyramid.boundsSize))
+					continue;
+				//Skip meshlets outside the view or facing away, and draw the rest in one call
+				meshletCuller.Cull(camera.frustum, camera.Position, visibleMeshlets);
+				meshletCounts.clear();
+				meshletOffsets.clear();
+				for (unsigned int m : visibleMeshlets)
+				{
+					meshletCounts.push_back(pyramidMeshlets.meshlets[m].indexCount);
+					meshletOffsets.push_back((const void*)(size_t)(pyramidMeshlets.meshlets[m].firstIndex * EBO1.IndexSize()));
+				}
+				DrawPacket draw = pyramidDraw;
+				draw.counts = meshletCounts.data();
+				draw.offsets = meshletOffsets.data();
+				draw.drawCount = (GLsizei)visibleMeshlets.size();
+				if (!visibleMeshlets.empty())
+					list.Submit(0, sort_depth(frame.viewProj, pyramid.boundsMin + pyramid.boundsSize * 0.5f), draw);
+			}
+		});
+		//Sort what was queued this frame and draw it
+		renderQueue.Flush();
 		//Now that we've drawn the shapes, swap the buffers
 		glfwSwapBuffers(window);
 
+		//Evict textures if this frame pushed us over budget
+		textures.Update();
+
 		//Take care of all GLFW events
 		glfwPollEvents();
 	};
@@ -139,8 +350,19 @@ int main()
 	VAO1.Delete();
 	VBO1.Delete();
 	EBO1.Delete();
-	pots.Delete();
-	shaderProgram.Delete();
+	wallVAO.Delete();
+	wallVBO.Delete();
+	wallEBO.Delete();
+	wallAtlas.Delete();
+	frameUniforms.Delete();
+	textureLoader.Delete();
+	workers.Delete();
+	textures.Delete();
+#ifdef _DEBUG
+	shaderWatcher.Delete();
+#endif
+	shaderCompiler.Delete();
+	shaders.Delete();
 
 	//Destroy the window before ending the program
 	glfwDestroyWindow(window);
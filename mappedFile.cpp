@@ -0,0 +1,116 @@
+#include "mappedFile.h"
+
+#include<sys/stat.h>
+#ifdef _WIN32
+#define NOMINMAX
+#include<windows.h>
+#include<direct.h>
+#else
+#include<sys/mman.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+bool MappedFile::Open(const char* filename) {
+	Close();
+#ifdef _WIN32
+	fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		fileHandle = NULL;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	size = (size_t)fileSize.QuadPart;
+	// Empty files can not be mapped, but they are still valid files
+	if (size == 0)
+		return true;
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle != NULL)
+		data = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat info;
+	fstat(fd, &info);
+	size = (size_t)info.st_size;
+	if (size == 0)
+	{
+		close(fd);
+		return true;
+	}
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mapping != MAP_FAILED)
+		data = (const unsigned char*)mapping;
+#endif
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mappingHandle != NULL)
+		CloseHandle(mappingHandle);
+	if (fileHandle != NULL)
+		CloseHandle(fileHandle);
+	mappingHandle = NULL;
+	fileHandle = NULL;
+#else
+	if (data != NULL)
+		munmap((void*)data, size);
+#endif
+	data = NULL;
+	size = 0;
+}
+
+FileStamp file_stamp(const char* filename) {
+	FileStamp stamp;
+#ifdef _WIN32
+	// _stat only keeps whole seconds, the attributes have the time in 100ns ticks
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &info))
+		return stamp;
+	stamp.mtime = (long long)(((unsigned long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+	stamp.size = (long long)(((unsigned long long)info.nFileSizeHigh << 32) | info.nFileSizeLow);
+#else
+	struct stat info;
+	if (stat(filename, &info) != 0)
+		return stamp;
+#ifdef __APPLE__
+	stamp.mtime = (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+	stamp.mtime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+	stamp.size = (long long)info.st_size;
+#endif
+	return stamp;
+}
+
+void make_directories(const std::string& path) {
+	for (size_t i = 1; i <= path.size(); i++)
+	{
+		if (i == path.size() || path[i] == '/' || path[i] == '\\')
+		{
+			std::string part = path.substr(0, i);
+#ifdef _WIN32
+			_mkdir(part.c_str());
+#else
+			mkdir(part.c_str(), 0755);
+#endif
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include<cstddef>
+#include<string>
+
+//Class maps a whole file read-only into memory so it can be used
+//without copying it through a stream first
+class MappedFile
+{
+public:
+	const unsigned char* data = NULL;
+	size_t size = 0;
+
+	MappedFile() {}
+	~MappedFile();
+	//A mapping owns an OS handle so it can not be copied
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Maps a file, returning false if it does not exist or can not be mapped
+	bool Open(const char* filename);
+	//Unmaps the file
+	void Close();
+
+private:
+#ifdef _WIN32
+	void* fileHandle = NULL;
+	void* mappingHandle = NULL;
+#endif
+};
+
+//Identifies one version of a file: its last modification time, as finely as the OS keeps it, and size
+//Saves within the same second still change the stamp, which whole second times would miss
+struct FileStamp
+{
+	long long mtime = 0;
+	long long size = -1;
+
+	bool operator==(const FileStamp& other) const { return mtime == other.mtime && size == other.size; }
+	bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+//Gets the stamp of a file, or the default one if it does not exist
+FileStamp file_stamp(const char* filename);
+//Creates a directory and any missing parents
+void make_directories(const std::string& path);
@@ -0,0 +1,286 @@
+#include "meshOptimizer.h"
+
+#include<algorithm>
+#include<cmath>
+#include<cstring>
+#include<vector>
+
+VertexCacheStats analyze_vertex_cache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize) {
+	// Time each vertex entered the cache; it is still cached while fewer than cacheSize misses have happened since
+	std::vector<size_t> entered(vertexCount, 0);
+	std::vector<bool> cached(vertexCount, false);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		GLuint v = indices[i];
+		used[v] = true;
+		if (cached[v] && misses - entered[v] < cacheSize)
+			continue;
+		cached[v] = true;
+		entered[v] = misses;
+		misses++;
+	}
+	size_t usedCount = std::count(used.begin(), used.end(), true);
+	VertexCacheStats stats;
+	stats.acmr = indexCount >= 3 ? (float)misses / (float)(indexCount / 3) : 0.0f;
+	stats.atvr = usedCount > 0 ? (float)misses / (float)usedCount : 0.0f;
+	return stats;
+}
+
+//Cache size the Forsyth scores are tuned for
+static const int forsythCache = 32;
+
+static float forsyth_score(int cachePosition, unsigned int remaining) {
+	// Vertices with no triangles left must never attract one
+	if (remaining == 0)
+		return -1.0f;
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score so the next triangle does not simply reuse an edge
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (float)(cachePosition - 3) / (float)(forsythCache - 3), 1.5f);
+	}
+	// Finish off vertices with few triangles left so they leave the working set
+	score += 2.0f / std::sqrt((float)remaining);
+	return score;
+}
+
+void optimize_vertex_cache(GLuint* indices, size_t indexCount, size_t vertexCount) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Triangles using each vertex; the first remaining[v] entries are the ones not emitted yet
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (size_t i = 0; i < indexCount; i++)
+		remaining[indices[i]]++;
+	std::vector<size_t> first(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		first[v + 1] = first[v] + remaining[v];
+	std::vector<unsigned int> adjacency(indexCount);
+	std::vector<size_t> fill(first.begin(), first.end() - 1);
+	for (size_t i = 0; i < indexCount; i++)
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = forsyth_score(-1, remaining[v]);
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<GLuint> output;
+	output.reserve(indexCount);
+	std::vector<GLuint> cache, nextCache;
+	size_t cursor = 0;
+	long long best = -1;
+	for (size_t n = 0; n < triangleCount; n++)
+	{
+		// Nothing in the cache has triangles left, start again from the first triangle not yet emitted
+		if (best < 0)
+		{
+			while (emitted[cursor])
+				cursor++;
+			best = (long long)cursor;
+		}
+		const GLuint* triangle = indices + best * 3;
+		emitted[best] = true;
+		output.insert(output.end(), triangle, triangle + 3);
+
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint v = triangle[k];
+			unsigned int* list = &adjacency[first[v]];
+			for (unsigned int j = 0; j < remaining[v]; j++)
+			{
+				if (list[j] == (unsigned int)best)
+				{
+					list[j] = list[remaining[v] - 1];
+					remaining[v]--;
+					break;
+				}
+			}
+		}
+
+		// The triangle's vertices move to the front of the LRU cache
+		nextCache.assign(triangle, triangle + 3);
+		for (GLuint v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				nextCache.push_back(v);
+		}
+		for (size_t i = 0; i < nextCache.size(); i++)
+			cachePosition[nextCache[i]] = i < forsythCache ? (int)i : -1;
+
+		// Rescore the vertices that moved and the triangles that use them, looking for the best next triangle
+		best = -1;
+		float bestScore = -1.0f;
+		for (GLuint v : nextCache)
+			vertexScore[v] = forsyth_score(cachePosition[v], remaining[v]);
+		for (GLuint v : nextCache)
+		{
+			for (unsigned int j = 0; j < remaining[v]; j++)
+			{
+				unsigned int t = adjacency[first[v] + j];
+				float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+		if (nextCache.size() > forsythCache)
+			nextCache.resize(forsythCache);
+		cache.swap(nextCache);
+	}
+	memcpy(indices, output.data(), indexCount * sizeof(GLuint));
+}
+
+void optimize_overdraw(GLuint* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t stride, float threshold) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+	if (stride == 0)
+		stride = sizeof(glm::vec3);
+	auto position = [&](GLuint v) -> const glm::vec3& { return *(const glm::vec3*)((const unsigned char*)positions + v * stride); };
+
+	// Cache misses per triangle in the current order, with the same FIFO model as analyze_vertex_cache
+	const unsigned int cacheSize = 16;
+	std::vector<size_t> entered(vertexCount, 0);
+	std::vector<bool> cached(vertexCount, false);
+	std::vector<unsigned char> triangleMisses(triangleCount);
+	size_t misses = 0;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		unsigned char count = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint v = indices[t * 3 + k];
+			if (cached[v] && misses - entered[v] < cacheSize)
+				continue;
+			cached[v] = true;
+			entered[v] = misses;
+			misses++;
+			count++;
+		}
+		triangleMisses[t] = count;
+	}
+
+	// Triangles that miss on every vertex start over with a cold cache, so moving them costs nothing
+	// Inside those clusters, cut once the piece so far, replayed from a cold cache as it would be after
+	// moving, is no worse than threshold times the cluster in its current order
+	std::vector<size_t> clusterStarts;
+	std::vector<size_t> piece(vertexCount, 0);
+	size_t pieceId = 0;
+	for (size_t t = 0; t < triangleCount;)
+	{
+		size_t end = t + 1;
+		while (end < triangleCount && triangleMisses[end] != 3)
+			end++;
+		size_t clusterMisses = 0;
+		for (size_t i = t; i < end; i++)
+			clusterMisses += triangleMisses[i];
+		float clusterAcmr = (float)clusterMisses / (float)(end - t);
+
+		size_t start = t;
+		size_t pieceMisses = 0;
+		pieceId++;
+		clusterStarts.push_back(start);
+		for (size_t i = t; i < end; i++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint v = indices[i * 3 + k];
+				if (piece[v] == pieceId && pieceMisses - entered[v] < cacheSize)
+					continue;
+				piece[v] = pieceId;
+				entered[v] = pieceMisses;
+				pieceMisses++;
+			}
+			size_t pieceSize = i + 1 - start;
+			if (i + 1 < end && (float)pieceMisses <= clusterAcmr * threshold * (float)pieceSize)
+			{
+				start = i + 1;
+				pieceMisses = 0;
+				pieceId++;
+				clusterStarts.push_back(start);
+			}
+		}
+		t = end;
+	}
+	clusterStarts.push_back(triangleCount);
+
+	// Middle of the mesh, by area
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const glm::vec3& a = position(indices[t * 3]);
+		const glm::vec3& b = position(indices[t * 3 + 1]);
+		const glm::vec3& c = position(indices[t * 3 + 2]);
+		float area = glm::length(glm::cross(b - a, c - a));
+		meshCenter += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	if (meshArea > 0.0f)
+		meshCenter /= meshArea;
+
+	// A cluster facing away from the middle is likely on the outside of the mesh and should be drawn first
+	size_t clusterCount = clusterStarts.size() - 1;
+	std::vector<float> sortKey(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		glm::vec3 center(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			const glm::vec3& p0 = position(indices[t * 3]);
+			const glm::vec3& p1 = position(indices[t * 3 + 1]);
+			const glm::vec3& p2 = position(indices[t * 3 + 2]);
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float a = glm::length(n);
+			center += (p0 + p1 + p2) * (a / 3.0f);
+			normal += n;
+			area += a;
+		}
+		if (area > 0.0f)
+			center /= area;
+		float length = glm::length(normal);
+		sortKey[c] = length > 0.0f ? glm::dot(center - meshCenter, normal / length) : 0.0f;
+	}
+	std::vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+		order[c] = c;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<GLuint> output;
+	output.reserve(indexCount);
+	for (size_t c : order)
+		output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+	memcpy(indices, output.data(), triangleCount * 3 * sizeof(GLuint));
+}
+
+size_t optimize_vertex_fetch(void* vertices, size_t vertexCount, size_t stride, GLuint* indices, size_t indexCount) {
+	const GLuint unused = 0xFFFFFFFF;
+	std::vector<GLuint> remap(vertexCount, unused);
+	GLuint next = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		GLuint& target = remap[indices[i]];
+		if (target == unused)
+			target = next++;
+		indices[i] = target;
+	}
+
+	std::vector<unsigned char> copy((const unsigned char*)vertices, (const unsigned char*)vertices + vertexCount * stride);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != unused)
+			memcpy((unsigned char*)vertices + remap[v] * stride, copy.data() + v * stride, stride);
+	}
+	return next;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<glm/glm/glm.hpp>
+
+//How well an index order uses the post-transform vertex cache, simulated as a FIFO
+struct VertexCacheStats
+{
+	//Average cache miss ratio: vertices transformed per triangle, 0.5 at best for big meshes and 3 at worst
+	float acmr;
+	//Average transform to vertex ratio: vertices transformed per vertex in the mesh, 1 is ideal
+	float atvr;
+};
+
+//Simulates a FIFO cache of cacheSize vertices, the common size on current GPUs is 16 to 32
+VertexCacheStats analyze_vertex_cache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+
+//Passes to run on a triangle list before it is uploaded, in this order:
+//optimize_vertex_cache, then optionally optimize_overdraw, then optimize_vertex_fetch
+
+//Reorders triangles so vertices are reused while they are still in the post-transform cache
+//Uses Forsyth's linear-speed algorithm with a 32 entry LRU cache model
+void optimize_vertex_cache(GLuint* indices, size_t indexCount, size_t vertexCount);
+
+//Reorders clusters of triangles so that those facing outwards from the middle of the mesh are drawn
+//first, which lets early depth testing reject more of what is drawn after them
+//Clusters are cut where it costs at most threshold times the vertex cache efficiency of the current order
+//positions is read every stride bytes, or tightly packed when stride is 0
+void optimize_overdraw(GLuint* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t stride = 0, float threshold = 1.05f);
+
+//Reorders vertices to the order the indices first use them, so vertex fetches walk memory forwards,
+//and rewrites the indices to match. Unused vertices are dropped; returns the new vertex count
+size_t optimize_vertex_fetch(void* vertices, size_t vertexCount, size_t stride, GLuint* indices, size_t indexCount);
@@ -0,0 +1,107 @@
+#include "meshPacking.h"
+
+#include<algorithm>
+#include<cmath>
+#include<glm/glm/gtc/packing.hpp>
+
+//Reads element i of an attribute that is stride bytes apart, or tightly packed when stride is 0
+template<typename T>
+static const T& element(const T* base, size_t i, size_t stride) {
+	return stride == 0 ? base[i] : *(const T*)((const unsigned char*)base + i * stride);
+}
+
+static unsigned short unorm16(float v) {
+	return (unsigned short)std::lround(glm::clamp(v, 0.0f, 1.0f) * 65535.0f);
+}
+
+static unsigned char unorm8(float v) {
+	return (unsigned char)std::lround(glm::clamp(v, 0.0f, 1.0f) * 255.0f);
+}
+
+glm::vec2 octahedral_encode(glm::vec3 normal) {
+	normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	glm::vec2 encoded(normal.x, normal.y);
+	// The lower half is folded over the diagonals onto the corners of the square
+	if (normal.z < 0.0f)
+	{
+		encoded.x = (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return encoded;
+}
+
+glm::vec3 octahedral_decode(glm::vec2 encoded) {
+	glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+	// Same as the shader: unfold the corners back into the lower half
+	float t = std::max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	return glm::normalize(normal);
+}
+
+PackedMesh pack_mesh(size_t count, const glm::vec3* positions, const glm::vec3* colors, const glm::vec2* texCoords, const glm::vec3* normals, size_t stride) {
+	PackedMesh mesh;
+	if (normals)
+		mesh.litVertices.resize(count);
+	else
+		mesh.vertices.resize(count);
+	mesh.unpackedBytes = count * sizeof(float) * (3 + (colors ? 3 : 0) + (texCoords ? 2 : 0) + (normals ? 3 : 0));
+
+	glm::vec3 low(0.0f), high(0.0f);
+	for (size_t i = 0; i < count; i++)
+	{
+		const glm::vec3& p = element(positions, i, stride);
+		low = i == 0 ? p : glm::min(low, p);
+		high = i == 0 ? p : glm::max(high, p);
+	}
+	mesh.boundsMin = low;
+	// A flat axis still needs a non zero size to divide by
+	mesh.boundsSize = glm::max(high - low, glm::vec3(1e-20f));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		PackedVertex v;
+
+		glm::vec3 p = element(positions, i, stride);
+		glm::vec3 unit = (p - mesh.boundsMin) / mesh.boundsSize;
+		for (int c = 0; c < 3; c++)
+			v.position[c] = unorm16(unit[c]);
+		v.position[3] = 0;
+		glm::vec3 decoded = mesh.boundsMin + glm::vec3(v.position[0], v.position[1], v.position[2]) / 65535.0f * mesh.boundsSize;
+		mesh.errors.position = std::max(mesh.errors.position, glm::length(decoded - p));
+
+		glm::vec3 color = colors ? element(colors, i, stride) : glm::vec3(1.0f);
+		for (int c = 0; c < 3; c++)
+		{
+			v.color[c] = unorm8(color[c]);
+			mesh.errors.color = std::max(mesh.errors.color, std::abs(v.color[c] / 255.0f - color[c]));
+		}
+		v.color[3] = 255;
+
+		glm::vec2 uv = texCoords ? element(texCoords, i, stride) : glm::vec2(0.0f);
+		for (int c = 0; c < 2; c++)
+		{
+			v.texCoord[c] = glm::packHalf1x16(uv[c]);
+			mesh.errors.texCoord = std::max(mesh.errors.texCoord, std::abs(glm::unpackHalf1x16(v.texCoord[c]) - uv[c]));
+		}
+
+		if (!normals)
+		{
+			mesh.vertices[i] = v;
+			continue;
+		}
+		PackedLitVertex& lit = mesh.litVertices[i];
+		std::copy(v.position, v.position + 4, lit.position);
+		std::copy(v.color, v.color + 4, lit.color);
+		std::copy(v.texCoord, v.texCoord + 2, lit.texCoord);
+		// The octahedron square is -1..1, stored as 0..1 so every OpenGL version decodes it the same way
+		glm::vec3 normal = glm::normalize(element(normals, i, stride));
+		glm::vec2 encoded = octahedral_encode(normal);
+		lit.normal[0] = unorm16(encoded.x * 0.5f + 0.5f);
+		lit.normal[1] = unorm16(encoded.y * 0.5f + 0.5f);
+		glm::vec3 unpacked = octahedral_decode(glm::vec2(lit.normal[0], lit.normal[1]) / 65535.0f * 2.0f - 1.0f);
+		float angle = std::acos(glm::clamp(glm::dot(unpacked, normal), -1.0f, 1.0f));
+		mesh.errors.normalDegrees = std::max(mesh.errors.normalDegrees, glm::degrees(angle));
+	}
+	return mesh;
+}
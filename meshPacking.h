@@ -0,0 +1,80 @@
+#pragma once
+
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "vertexLayout.h"
+
+//A vertex with its attributes quantized, 16 bytes instead of the 32 of float position, color and texture coordinates
+struct PackedVertex
+{
+	//Position within the mesh's bounding box as unorm16, the fourth value is unused
+	//Unorm rather than snorm because OpenGL 3.3 and 4.2+ convert snorm differently
+	unsigned short position[4];
+	//RGBA as unorm8
+	unsigned char color[4];
+	//Texture coordinates as half floats, which keeps repeating coordinates outside 0..1 working
+	unsigned short texCoord[2];
+};
+
+//The same with a normal, 20 bytes instead of 44, for meshes that have normals
+struct PackedLitVertex
+{
+	unsigned short position[4];
+	unsigned char color[4];
+	unsigned short texCoord[2];
+	//Unit normal folded onto an octahedron, stored as unorm16 for the same reason as position
+	//and moved back to -1..1 by decodeNormal
+	unsigned short normal[2];
+};
+
+//Locations match the float attributes they replace, so shaders only add the decode of PACKED_VERTICES
+//Location 3 is left to the per instance attribute of INSTANCING
+using PackedVertexLayout = VertexLayout<PackedVertex,
+	VERTEX_ATTRIB(0, UNorm16x4, PackedVertex, position),
+	VERTEX_ATTRIB(1, UNorm8x4, PackedVertex, color),
+	VERTEX_ATTRIB(2, Half2, PackedVertex, texCoord)>;
+using PackedLitVertexLayout = VertexLayout<PackedLitVertex,
+	VERTEX_ATTRIB(0, UNorm16x4, PackedLitVertex, position),
+	VERTEX_ATTRIB(1, UNorm8x4, PackedLitVertex, color),
+	VERTEX_ATTRIB(2, Half2, PackedLitVertex, texCoord),
+	VERTEX_ATTRIB(4, UNorm16x2, PackedLitVertex, normal)>;
+
+//Largest differences between the original attributes and what the shader will decode
+struct PackingErrors
+{
+	//Distance in mesh units
+	float position = 0.0f;
+	//Per channel, in 0..1
+	float color = 0.0f;
+	float texCoord = 0.0f;
+	//Angle between normals
+	float normalDegrees = 0.0f;
+};
+
+//Vertices ready to upload, and the bounding box the shader needs to place them: position = boundsMin + decoded * boundsSize
+//Only one of vertices and litVertices is filled: litVertices when normals were given, so meshes
+//without normals do not pay for an unused normal in every vertex
+struct PackedMesh
+{
+	std::vector<PackedVertex> vertices;
+	std::vector<PackedLitVertex> litVertices;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsSize;
+	PackingErrors errors;
+	//Bytes the same vertices take as floats, with the attributes that were given
+	size_t unpackedBytes;
+
+	//The filled vertex array, ready for a VBO
+	const void* Data() const { return litVertices.empty() ? (const void*)vertices.data() : (const void*)litVertices.data(); }
+	size_t Bytes() const { return vertices.size() * sizeof(PackedVertex) + litVertices.size() * sizeof(PackedLitVertex); }
+};
+
+//Quantizes a mesh's vertices, measuring the error it introduces
+//Any attribute pointer may be NULL (white and 0 are used, and no normal is stored); stride is the byte distance between
+//consecutive vertices, so attributes can be read straight out of an array of vertex structs, or 0 for tight arrays
+PackedMesh pack_mesh(size_t count, const glm::vec3* positions, const glm::vec3* colors, const glm::vec2* texCoords, const glm::vec3* normals, size_t stride = 0);
+
+//Folds a unit vector onto an octahedron and unfolds it into the -1..1 square, and back
+glm::vec2 octahedral_encode(glm::vec3 normal);
+glm::vec3 octahedral_decode(glm::vec2 encoded);
@@ -0,0 +1,269 @@
+#include "meshlets.h"
+
+#include<algorithm>
+#include<cmath>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define CULL_AVX2
+#define CULL_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include<emmintrin.h>
+#define CULL_SSE2
+#elif defined(__ARM_NEON)
+#include<arm_neon.h>
+#define CULL_NEON
+#endif
+
+MeshletMesh build_meshlets(const GLuint* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t stride, unsigned int maxVertices, unsigned int maxTriangles) {
+	if (stride == 0)
+		stride = sizeof(glm::vec3);
+	auto position = [&](GLuint v) -> const glm::vec3& { return *(const glm::vec3*)((const unsigned char*)positions + v * stride); };
+
+	MeshletMesh mesh;
+	mesh.indices.assign(indices, indices + indexCount);
+	// Which meshlet last used each vertex, so counting new vertices needs no clearing between meshlets
+	std::vector<size_t> usedBy(vertexCount, (size_t)-1);
+	std::vector<GLuint> meshletVertices;
+	Meshlet current = { 0, 0, 0 };
+	size_t triangleCount = indexCount / 3;
+
+	auto finish = [&]() {
+		MeshletBounds bounds;
+		glm::vec3 low = position(meshletVertices[0]), high = low;
+		for (GLuint v : meshletVertices)
+		{
+			low = glm::min(low, position(v));
+			high = glm::max(high, position(v));
+		}
+		bounds.center = (low + high) * 0.5f;
+		bounds.radius = 0.0f;
+		for (GLuint v : meshletVertices)
+			bounds.radius = std::max(bounds.radius, glm::length(position(v) - bounds.center));
+
+		// The cone has to hold every triangle's normal; degenerate triangles face nowhere and are skipped
+		std::vector<glm::vec3> normals;
+		glm::vec3 sum(0.0f);
+		for (GLsizei i = 0; i < current.indexCount; i += 3)
+		{
+			const GLuint* t = &mesh.indices[current.firstIndex + i];
+			glm::vec3 n = glm::cross(position(t[1]) - position(t[0]), position(t[2]) - position(t[0]));
+			float length = glm::length(n);
+			if (length <= 0.0f)
+				continue;
+			normals.push_back(n / length);
+			sum += n / length;
+		}
+		float sumLength = glm::length(sum);
+		float lowestDot = 1.0f;
+		for (const glm::vec3& n : normals)
+			lowestDot = std::min(lowestDot, sumLength > 0.0f ? glm::dot(n, sum / sumLength) : -1.0f);
+		// Past about 84 degrees from the axis the cone is too wide to ever cull anything useful
+		if (normals.empty() || lowestDot <= 0.1f)
+		{
+			bounds.coneAxis = glm::vec3(0.0f);
+			bounds.coneCutoff = 1.0f;
+		}
+		else
+		{
+			bounds.coneAxis = sum / sumLength;
+			bounds.coneCutoff = std::sqrt(1.0f - lowestDot * lowestDot);
+		}
+
+		current.vertexCount = (unsigned int)meshletVertices.size();
+		mesh.meshlets.push_back(current);
+		mesh.bounds.push_back(bounds);
+		meshletVertices.clear();
+		current.firstIndex += current.indexCount;
+		current.indexCount = 0;
+	};
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const GLuint* triangle = indices + t * 3;
+		size_t meshletId = mesh.meshlets.size();
+		unsigned int added = 0;
+		for (int k = 0; k < 3; k++)
+			added += usedBy[triangle[k]] != meshletId ? 1 : 0;
+		if (meshletVertices.size() + added > maxVertices || (unsigned int)current.indexCount / 3 + 1 > maxTriangles)
+		{
+			finish();
+			meshletId++;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			if (usedBy[triangle[k]] != meshletId)
+			{
+				usedBy[triangle[k]] = meshletId;
+				meshletVertices.push_back(triangle[k]);
+			}
+		}
+		current.indexCount += 3;
+	}
+	if (current.indexCount > 0)
+		finish();
+	return mesh;
+}
+
+MeshletCuller::MeshletCuller(const MeshletMesh& mesh) {
+	for (size_t i = 0; i < mesh.meshlets.size(); i++)
+	{
+		const MeshletBounds& b = mesh.bounds[i];
+		centerX.push_back(b.center.x);
+		centerY.push_back(b.center.y);
+		centerZ.push_back(b.center.z);
+		radius.push_back(b.radius);
+		axisX.push_back(b.coneAxis.x);
+		axisY.push_back(b.coneAxis.y);
+		axisZ.push_back(b.coneAxis.z);
+		cutoff.push_back(b.coneCutoff);
+		triangleCounts.push_back((unsigned int)mesh.meshlets[i].indexCount / 3);
+	}
+}
+
+size_t MeshletCuller::Cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<unsigned int>& visible, ThreadPool* pool, bool forceScalar) {
+	visible.clear();
+	size_t count = triangleCounts.size();
+	const size_t grain = 4096;
+	if (pool == NULL || count <= grain)
+		return CullRange(0, count, frustum, cameraPosition, visible, forceScalar);
+
+	// Each chunk collects its own list, joined in chunk order so the result matches the single threaded one
+	size_t chunks = (count + grain - 1) / grain;
+	std::vector<std::vector<unsigned int>> chunkVisible(chunks);
+	std::vector<size_t> chunkTriangles(chunks, 0);
+	pool->ParallelFor(count, grain, [&](size_t begin, size_t end) {
+		size_t chunk = begin / grain;
+		chunkTriangles[chunk] = CullRange(begin, end, frustum, cameraPosition, chunkVisible[chunk], forceScalar);
+	});
+	size_t triangles = 0;
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		visible.insert(visible.end(), chunkVisible[chunk].begin(), chunkVisible[chunk].end());
+		triangles += chunkTriangles[chunk];
+	}
+	return triangles;
+}
+
+size_t MeshletCuller::CullRange(size_t begin, size_t end, const Frustum& frustum, const glm::vec3& camera, std::vector<unsigned int>& visible, bool forceScalar) {
+	size_t triangles = 0;
+	size_t i = begin;
+	if (!forceScalar)
+	{
+#if defined(CULL_AVX2)
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 cx = _mm256_loadu_ps(&centerX[i]), cy = _mm256_loadu_ps(&centerY[i]), cz = _mm256_loadu_ps(&centerZ[i]);
+			__m256 r = _mm256_loadu_ps(&radius[i]);
+			__m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const glm::vec4& p : frustum.planes)
+			{
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), cx), _mm256_mul_ps(_mm256_set1_ps(p.y), cy)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z), cz), _mm256_set1_ps(p.w)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+			}
+			__m256 dx = _mm256_sub_ps(cx, _mm256_set1_ps(camera.x)), dy = _mm256_sub_ps(cy, _mm256_set1_ps(camera.y)), dz = _mm256_sub_ps(cz, _mm256_set1_ps(camera.z));
+			__m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz)));
+			__m256 facing = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_loadu_ps(&axisX[i])), _mm256_mul_ps(dy, _mm256_loadu_ps(&axisY[i]))), _mm256_mul_ps(dz, _mm256_loadu_ps(&axisZ[i])));
+			__m256 backLimit = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&cutoff[i]), length), r);
+			__m256 keep = _mm256_andnot_ps(_mm256_cmp_ps(facing, backLimit, _CMP_GE_OQ), inside);
+			int mask = _mm256_movemask_ps(keep);
+			for (int lane = 0; lane < 8; lane++)
+			{
+				if (mask & (1 << lane))
+				{
+					visible.push_back((unsigned int)(i + lane));
+					triangles += triangleCounts[i + lane];
+				}
+			}
+		}
+#endif
+#if defined(CULL_SSE2)
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+			__m128 r = _mm_loadu_ps(&radius[i]);
+			__m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& p : frustum.planes)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), cx), _mm_mul_ps(_mm_set1_ps(p.y), cy)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), cz), _mm_set1_ps(p.w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+			}
+			__m128 dx = _mm_sub_ps(cx, _mm_set1_ps(camera.x)), dy = _mm_sub_ps(cy, _mm_set1_ps(camera.y)), dz = _mm_sub_ps(cz, _mm_set1_ps(camera.z));
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+			__m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&axisY[i]))), _mm_mul_ps(dz, _mm_loadu_ps(&axisZ[i])));
+			__m128 backLimit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&cutoff[i]), length), r);
+			__m128 keep = _mm_andnot_ps(_mm_cmpge_ps(facing, backLimit), inside);
+			int mask = _mm_movemask_ps(keep);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (mask & (1 << lane))
+				{
+					visible.push_back((unsigned int)(i + lane));
+					triangles += triangleCounts[i + lane];
+				}
+			}
+		}
+#elif defined(CULL_NEON)
+		for (; i + 4 <= end; i += 4)
+		{
+			float32x4_t cx = vld1q_f32(&centerX[i]), cy = vld1q_f32(&centerY[i]), cz = vld1q_f32(&centerZ[i]);
+			float32x4_t r = vld1q_f32(&radius[i]);
+			float32x4_t negR = vnegq_f32(r);
+			uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+			for (const glm::vec4& p : frustum.planes)
+			{
+				float32x4_t d = vaddq_f32(vaddq_f32(vmulq_n_f32(cx, p.x), vmulq_n_f32(cy, p.y)), vaddq_f32(vmulq_n_f32(cz, p.z), vdupq_n_f32(p.w)));
+				inside = vandq_u32(inside, vcgeq_f32(d, negR));
+			}
+			float32x4_t dx = vsubq_f32(cx, vdupq_n_f32(camera.x)), dy = vsubq_f32(cy, vdupq_n_f32(camera.y)), dz = vsubq_f32(cz, vdupq_n_f32(camera.z));
+			float32x4_t length = vsqrtq_f32(vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz)));
+			float32x4_t facing = vaddq_f32(vaddq_f32(vmulq_f32(dx, vld1q_f32(&axisX[i])), vmulq_f32(dy, vld1q_f32(&axisY[i]))), vmulq_f32(dz, vld1q_f32(&axisZ[i])));
+			float32x4_t backLimit = vaddq_f32(vmulq_f32(vld1q_f32(&cutoff[i]), length), r);
+			uint32x4_t keep = vbicq_u32(inside, vcgeq_f32(facing, backLimit));
+			uint32_t lanes[4];
+			vst1q_u32(lanes, keep);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (lanes[lane])
+				{
+					visible.push_back((unsigned int)(i + lane));
+					triangles += triangleCounts[i + lane];
+				}
+			}
+		}
+#endif
+	}
+	// Same tests one meshlet at a time, for the tail and for machines without SIMD
+	for (; i < end; i++)
+	{
+		bool inside = true;
+		for (const glm::vec4& p : frustum.planes)
+			inside = inside && (p.x * centerX[i] + p.y * centerY[i]) + (p.z * centerZ[i] + p.w) >= -radius[i];
+		float dx = centerX[i] - camera.x, dy = centerY[i] - camera.y, dz = centerZ[i] - camera.z;
+		float length = std::sqrt((dx * dx + dy * dy) + dz * dz);
+		float facing = (dx * axisX[i] + dy * axisY[i]) + dz * axisZ[i];
+		bool backFacing = facing >= cutoff[i] * length + radius[i];
+		if (inside && !backFacing)
+		{
+			visible.push_back((unsigned int)i);
+			triangles += triangleCounts[i];
+		}
+	}
+	return triangles;
+}
+
+const char* cull_simd_name() {
+#if defined(CULL_AVX2)
+	return "AVX2";
+#elif defined(CULL_SSE2)
+	return "SSE2";
+#elif defined(CULL_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
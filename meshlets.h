@@ -0,0 +1,67 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "frustum.h"
+#include "threadPool.h"
+
+//A small piece of a mesh, drawn as its own range of the meshlet index buffer
+struct Meshlet
+{
+	GLuint firstIndex;
+	GLsizei indexCount;
+	unsigned int vertexCount;
+};
+
+//What a meshlet's culling is based on
+struct MeshletBounds
+{
+	//Sphere around every vertex of the meshlet
+	glm::vec3 center;
+	float radius;
+	//Cone around the normals of its triangles: the meshlet faces away from any camera inside the
+	//cone behind it, i.e. when dot(center - camera, coneAxis) >= coneCutoff * |center - camera| + radius
+	//Meshlets whose triangles face too many ways to be culled have a zero axis and a cutoff of 1
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+//A mesh split into meshlets, with its triangles grouped by meshlet in indices
+struct MeshletMesh
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> bounds;
+	std::vector<GLuint> indices;
+};
+
+//Splits a triangle list into meshlets of up to maxVertices vertices and maxTriangles triangles
+//Triangles are taken in order, so run optimize_vertex_cache first for compact meshlets
+//positions is read every stride bytes, or tightly packed when stride is 0
+MeshletMesh build_meshlets(const GLuint* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t stride = 0, unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+//Class throws away meshlets that are outside the frustum or face away from the camera,
+//testing bounds kept as separate arrays per component so SIMD can test 4 or 8 meshlets at a time
+//The frustum and camera must be in the mesh's space, e.g. from projection * view * model
+class MeshletCuller
+{
+public:
+	MeshletCuller(const MeshletMesh& mesh);
+
+	//Replaces visible with the meshlets that may be seen, in order, and returns how many triangles they hold
+	//With a pool, chunks of meshlets are tested in parallel
+	size_t Cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<unsigned int>& visible, ThreadPool* pool = NULL, bool forceScalar = false);
+	size_t Size() { return triangleCounts.size(); }
+
+private:
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<float> axisX, axisY, axisZ, cutoff;
+	std::vector<unsigned int> triangleCounts;
+
+	//Tests meshlets [begin, end), appending the visible ones
+	size_t CullRange(size_t begin, size_t end, const Frustum& frustum, const glm::vec3& camera, std::vector<unsigned int>& visible, bool forceScalar);
+};
+
+//Name of the instruction set MeshletCuller uses
+const char* cull_simd_name();
@@ -0,0 +1,321 @@
+#include "mipmap.h"
+
+#include<algorithm>
+#include<cmath>
+#include<functional>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define MIP_AVX2
+#define MIP_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include<emmintrin.h>
+#define MIP_SSE2
+#elif defined(__ARM_NEON)
+#include<arm_neon.h>
+#define MIP_NEON
+#endif
+
+//A fused multiply-add rounds once where a multiply then an add rounds twice, so letting the
+//compiler fuse some of them would make the scalar and SIMD paths disagree; keep them apart here
+//whatever the build flags say
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+//Each filter is a set of weights over source pixels 2x + offset .. 2x + offset + taps - 1
+struct Kernel
+{
+	int taps;
+	int offset;
+	float weights[8];
+};
+
+//Weights are written out rather than computed so every platform filters with the same numbers
+static const Kernel boxKernel = { 2, 0, { 0.5f, 0.5f } };
+//Kaiser windowed sinc, alpha 4, half width of 4 source pixels
+static const Kernel kaiserKernel = { 8, -3, { -0.012423150f, -0.042995105f, 0.116919843f, 0.438498412f, 0.438498412f, 0.116919843f, -0.042995105f, -0.012423150f } };
+//Lanczos 2 stretched to a 2:1 reduction
+static const Kernel lanczosKernel = { 8, -3, { -0.008863332f, -0.041940034f, 0.116500094f, 0.434303272f, 0.434303272f, 0.116500094f, -0.041940034f, -0.008863332f } };
+
+//Working images always hold 4 floats per pixel so one pixel fits one SSE register
+struct FloatImage
+{
+	int width;
+	int height;
+	std::vector<float> texels;
+};
+
+//Tables for converting between sRGB bytes and linear light
+struct SrgbTables
+{
+	float toLinear[256];
+	//Linear value halfway (in sRGB space) between code i - 1 and code i
+	float thresholds[256];
+
+	SrgbTables() {
+		for (int i = 0; i < 256; i++)
+		{
+			toLinear[i] = decode(i / 255.0);
+			thresholds[i] = i == 0 ? 0.0f : decode((i - 0.5) / 255.0);
+		}
+	}
+	static float decode(double c) {
+		return (float)(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+	}
+};
+
+static const SrgbTables& srgbTables() {
+	static const SrgbTables tables;
+	return tables;
+}
+
+static unsigned char encodeLinear(float v) {
+	if (!(v > 0.0f))
+		return 0;
+	if (v >= 1.0f)
+		return 255;
+	return (unsigned char)(v * 255.0f + 0.5f);
+}
+
+//Finds the sRGB code whose range holds v, an exact inverse of the thresholds table
+static unsigned char encodeSrgb(float v) {
+	const float* thresholds = srgbTables().thresholds;
+	int code = 0;
+	for (int step = 128; step > 0; step >>= 1)
+	{
+		if (thresholds[code + step] <= v)
+			code += step;
+	}
+	return (unsigned char)code;
+}
+
+static int clampIndex(int i, int size) {
+	return i < 0 ? 0 : (i >= size ? size - 1 : i);
+}
+
+//Filters and halves one row of pixels, writing dstWidth pixels
+static void filterRowScalar(const float* src, int srcWidth, float* dst, int dstWidth, const Kernel& kernel) {
+	for (int x = 0; x < dstWidth; x++)
+	{
+		float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int k = 0; k < kernel.taps; k++)
+		{
+			const float* p = src + clampIndex(2 * x + k + kernel.offset, srcWidth) * 4;
+			for (int c = 0; c < 4; c++)
+			{
+				float product = kernel.weights[k] * p[c];
+				sum[c] = sum[c] + product;
+			}
+		}
+		for (int c = 0; c < 4; c++)
+			dst[x * 4 + c] = sum[c];
+	}
+}
+
+//Combines whole source rows with the kernel weights, used for the vertical pass
+static void filterColumnsScalar(const float* const* rows, const Kernel& kernel, float* dst, int count) {
+	for (int i = 0; i < count; i++)
+	{
+		float sum = 0.0f;
+		for (int k = 0; k < kernel.taps; k++)
+		{
+			float product = kernel.weights[k] * rows[k][i];
+			sum = sum + product;
+		}
+		dst[i] = sum;
+	}
+}
+
+#if defined(MIP_SSE2)
+static void filterRowSimd(const float* src, int srcWidth, float* dst, int dstWidth, const Kernel& kernel) {
+	for (int x = 0; x < dstWidth; x++)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (int k = 0; k < kernel.taps; k++)
+		{
+			__m128 p = _mm_loadu_ps(src + clampIndex(2 * x + k + kernel.offset, srcWidth) * 4);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), p));
+		}
+		_mm_storeu_ps(dst + x * 4, sum);
+	}
+}
+
+static void filterColumnsSimd(const float* const* rows, const Kernel& kernel, float* dst, int count) {
+	int i = 0;
+#if defined(MIP_AVX2)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 sum = _mm256_setzero_ps();
+		for (int k = 0; k < kernel.taps; k++)
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel.weights[k]), _mm256_loadu_ps(rows[k] + i)));
+		_mm256_storeu_ps(dst + i, sum);
+	}
+#endif
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (int k = 0; k < kernel.taps; k++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(rows[k] + i)));
+		_mm_storeu_ps(dst + i, sum);
+	}
+	filterColumnsScalar(rows, kernel, dst + i, count - i);
+}
+#elif defined(MIP_NEON)
+//vmlaq_f32 may be fused on some cores, so multiply and add are kept separate to match the scalar path
+static void filterRowSimd(const float* src, int srcWidth, float* dst, int dstWidth, const Kernel& kernel) {
+	for (int x = 0; x < dstWidth; x++)
+	{
+		float32x4_t sum = vdupq_n_f32(0.0f);
+		for (int k = 0; k < kernel.taps; k++)
+		{
+			float32x4_t p = vld1q_f32(src + clampIndex(2 * x + k + kernel.offset, srcWidth) * 4);
+			sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(kernel.weights[k]), p));
+		}
+		vst1q_f32(dst + x * 4, sum);
+	}
+}
+
+static void filterColumnsSimd(const float* const* rows, const Kernel& kernel, float* dst, int count) {
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4_t sum = vdupq_n_f32(0.0f);
+		for (int k = 0; k < kernel.taps; k++)
+			sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(kernel.weights[k]), vld1q_f32(rows[k] + i)));
+		vst1q_f32(dst + i, sum);
+	}
+	filterColumnsScalar(rows, kernel, dst + i, count - i);
+}
+#else
+static void filterRowSimd(const float* src, int srcWidth, float* dst, int dstWidth, const Kernel& kernel) {
+	filterRowScalar(src, srcWidth, dst, dstWidth, kernel);
+}
+
+static void filterColumnsSimd(const float* const* rows, const Kernel& kernel, float* dst, int count) {
+	filterColumnsScalar(rows, kernel, dst, count);
+}
+#endif
+
+const char* mip_simd_name() {
+#if defined(MIP_AVX2)
+	return "AVX2";
+#elif defined(MIP_SSE2)
+	return "SSE2";
+#elif defined(MIP_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+//Runs body over [0, count) on the pool, or inline without one
+static void forRows(ThreadPool* pool, int count, const std::function<void(size_t, size_t)>& body) {
+	if (pool != NULL)
+		pool->ParallelFor((size_t)count, 16, body);
+	else
+		body(0, (size_t)count);
+}
+
+//Halves an image, horizontal pass first then vertical
+static FloatImage downsample(const FloatImage& src, const Kernel& kernel, ThreadPool* pool, bool forceScalar) {
+	// A side that is already 1 pixel is copied instead of filtered
+	static const Kernel copyKernel = { 1, 0, { 1.0f } };
+	const Kernel& rowKernel = src.width > 1 ? kernel : copyKernel;
+	const Kernel& columnKernel = src.height > 1 ? kernel : copyKernel;
+	int width = src.width > 1 ? src.width / 2 : 1;
+	int height = src.height > 1 ? src.height / 2 : 1;
+	// Halving a size of 1 would read pixel 2x = 0 only, so the copy kernel steps by 0 there
+	int rowStep = src.width > 1 ? 2 : 0;
+	int columnStep = src.height > 1 ? 2 : 0;
+
+	FloatImage rows;
+	rows.width = width;
+	rows.height = src.height;
+	rows.texels.resize((size_t)width * src.height * 4);
+	forRows(pool, src.height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++)
+		{
+			const float* in = src.texels.data() + y * src.width * 4;
+			float* out = rows.texels.data() + y * width * 4;
+			if (rowStep == 0)
+				std::copy(in, in + 4, out);
+			else if (forceScalar)
+				filterRowScalar(in, src.width, out, width, rowKernel);
+			else
+				filterRowSimd(in, src.width, out, width, rowKernel);
+		}
+	});
+
+	FloatImage dst;
+	dst.width = width;
+	dst.height = height;
+	dst.texels.resize((size_t)width * height * 4);
+	forRows(pool, height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++)
+		{
+			const float* taps[8];
+			for (int k = 0; k < columnKernel.taps; k++)
+				taps[k] = rows.texels.data() + (size_t)clampIndex(columnStep * (int)y + k + columnKernel.offset, rows.height) * width * 4;
+			float* out = dst.texels.data() + y * width * 4;
+			if (forceScalar)
+				filterColumnsScalar(taps, columnKernel, out, width * 4);
+			else
+				filterColumnsSimd(taps, columnKernel, out, width * 4);
+		}
+	});
+	return dst;
+}
+
+std::vector<MipLevel> build_mip_chain(const TextureImage& image, MipFilter filter, bool srgb, ThreadPool* pool, bool forceScalar) {
+	std::vector<MipLevel> levels;
+	if (image.bytes == NULL || (image.width == 1 && image.height == 1))
+		return levels;
+	const Kernel& kernel = filter == MipFilter::Box ? boxKernel : (filter == MipFilter::Kaiser ? kaiserKernel : lanczosKernel);
+	int channels = image.numColCh;
+	// The last channel of 2 and 4 channel images is alpha
+	int colorChannels = channels == 4 || channels == 2 ? channels - 1 : channels;
+	const float* toLinear = srgbTables().toLinear;
+
+	// Expand the source to linear RGBA floats
+	FloatImage current;
+	current.width = image.width;
+	current.height = image.height;
+	current.texels.assign((size_t)image.width * image.height * 4, 1.0f);
+	forRows(pool, image.height, [&](size_t begin, size_t end) {
+		for (size_t i = begin * image.width; i < end * image.width; i++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				unsigned char v = image.bytes[i * channels + c];
+				current.texels[i * 4 + c] = srgb && c < colorChannels ? toLinear[v] : v / 255.0f;
+			}
+		}
+	});
+
+	while (current.width > 1 || current.height > 1)
+	{
+		current = downsample(current, kernel, pool, forceScalar);
+
+		MipLevel level;
+		level.width = current.width;
+		level.height = current.height;
+		level.texels.resize((size_t)current.width * current.height * channels);
+		forRows(pool, current.height, [&](size_t begin, size_t end) {
+			for (size_t i = begin * current.width; i < end * current.width; i++)
+			{
+				for (int c = 0; c < channels; c++)
+				{
+					float v = current.texels[i * 4 + c];
+					level.texels[i * channels + c] = srgb && c < colorChannels ? encodeSrgb(v) : encodeLinear(v);
+				}
+			}
+		});
+		levels.push_back(std::move(level));
+	}
+	return levels;
+}
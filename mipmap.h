@@ -0,0 +1,33 @@
+#pragma once
+
+#include<vector>
+
+#include "texture.h"
+#include "threadPool.h"
+
+//Filters the CPU mip chain builder can use
+//Box is the classic 2x2 average, Kaiser and Lanczos are 8 tap windowed sincs that keep more detail
+enum class MipFilter
+{
+	Box,
+	Kaiser,
+	Lanczos
+};
+
+//One generated mip level, tightly packed with the source image's channel count
+struct MipLevel
+{
+	int width;
+	int height;
+	std::vector<unsigned char> texels;
+};
+
+//Builds mip levels 1 and up for an image, down to 1x1
+//With srgb set, color channels are converted to linear light before filtering and back afterwards
+//(alpha is always treated as linear). Rows are split across the pool when one is given.
+//The output only depends on the input, never on thread count or which SIMD path ran;
+//mipmap.cpp turns off multiply-add fusing for itself so build flags can not change that
+std::vector<MipLevel> build_mip_chain(const TextureImage& image, MipFilter filter, bool srgb, ThreadPool* pool = NULL, bool forceScalar = false);
+
+//Name of the SIMD instruction set build_mip_chain uses in this build
+const char* mip_simd_name();
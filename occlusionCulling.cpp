@@ -0,0 +1,291 @@
+#include "occlusionCulling.h"
+
+#include<algorithm>
+#include<cmath>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define OCCLUSION_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include<emmintrin.h>
+#define OCCLUSION_SSE2
+#elif defined(__ARM_NEON)
+#include<arm_neon.h>
+#define OCCLUSION_NEON
+#endif
+
+//Tiles are whole 8x8 blocks, so SIMD rows never cross a tile and each tile owns its blocks
+static const int tileSize = 32;
+static const int blockSize = 8;
+
+OcclusionCuller::OcclusionCuller(int width, int height) {
+	tilesX = (std::max(width, 1) + tileSize - 1) / tileSize;
+	tilesY = (std::max(height, 1) + tileSize - 1) / tileSize;
+	OcclusionCuller::width = tilesX * tileSize;
+	OcclusionCuller::height = tilesY * tileSize;
+	depth.assign((size_t)OcclusionCuller::width * OcclusionCuller::height, 1.0f);
+	blockDepth.assign(depth.size() / (blockSize * blockSize), 1.0f);
+	bins.resize((size_t)tilesX * tilesY);
+	viewProj = glm::mat4(1.0f);
+}
+
+void OcclusionCuller::Begin(const glm::mat4& viewProj) {
+	OcclusionCuller::viewProj = viewProj;
+	triangles.clear();
+}
+
+void OcclusionCuller::AddOccluder(const glm::vec3* positions, size_t stride, const GLuint* indices, size_t indexCount, const glm::mat4& model) {
+	if (stride == 0)
+		stride = sizeof(glm::vec3);
+	glm::mat4 transform = viewProj * model;
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		glm::vec4 clip[3];
+		for (int k = 0; k < 3; k++)
+			clip[k] = transform * glm::vec4(*(const glm::vec3*)((const unsigned char*)positions + indices[i + k] * stride), 1.0f);
+
+		// Clip against the near plane (z >= -w), which leaves a triangle or a quad
+		glm::vec4 polygon[4];
+		int count = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			const glm::vec4& a = clip[k];
+			const glm::vec4& b = clip[(k + 1) % 3];
+			float da = a.z + a.w, db = b.z + b.w;
+			if (da >= 0.0f)
+				polygon[count++] = a;
+			if ((da >= 0.0f) != (db >= 0.0f))
+				polygon[count++] = a + (b - a) * (da / (da - db));
+		}
+		for (int k = 1; k + 1 < count; k++)
+		{
+			glm::vec4 fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+			AddTriangle(fan);
+		}
+	}
+}
+
+void OcclusionCuller::AddTriangle(const glm::vec4* clip) {
+	float x[3], y[3], z[3];
+	for (int k = 0; k < 3; k++)
+	{
+		x[k] = (clip[k].x / clip[k].w * 0.5f + 0.5f) * width;
+		y[k] = (clip[k].y / clip[k].w * 0.5f + 0.5f) * height;
+		z[k] = clip[k].z / clip[k].w * 0.5f + 0.5f;
+	}
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (std::fabs(area) < 1e-6f)
+		return;
+
+	// Pixel i is covered when its center i + 0.5 is inside
+	Triangle t;
+	t.minX = std::max((int)std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f), 0);
+	t.maxX = std::min((int)std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f), width - 1);
+	t.minY = std::max((int)std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f), 0);
+	t.maxY = std::min((int)std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f), height - 1);
+	if (t.minX > t.maxX || t.minY > t.maxY || std::min({ z[0], z[1], z[2] }) > 1.0f)
+		return;
+
+	// Both windings hide what is behind them, so flip clockwise edges to stay positive inside
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	for (int k = 0; k < 3; k++)
+	{
+		int a = k, b = (k + 1) % 3;
+		t.edgeA[k] = -(y[b] - y[a]) * sign;
+		t.edgeB[k] = (x[b] - x[a]) * sign;
+		t.edgeC[k] = -(t.edgeA[k] * x[a] + t.edgeB[k] * y[a]);
+	}
+	t.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	t.depthB = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+	t.depthC = z[0] - t.depthA * x[0] - t.depthB * y[0];
+	triangles.push_back(t);
+}
+
+void OcclusionCuller::Rasterize(ThreadPool* pool, bool forceScalar) {
+	for (std::vector<unsigned int>& bin : bins)
+		bin.clear();
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		const Triangle& t = triangles[i];
+		for (int ty = t.minY / tileSize; ty <= t.maxY / tileSize; ty++)
+		{
+			for (int tx = t.minX / tileSize; tx <= t.maxX / tileSize; tx++)
+				bins[ty * tilesX + tx].push_back((unsigned int)i);
+		}
+	}
+
+	size_t tiles = bins.size();
+	if (pool == NULL)
+	{
+		for (size_t tile = 0; tile < tiles; tile++)
+			RasterizeTile((int)tile, forceScalar);
+		return;
+	}
+	// Tiles share no pixels, so they can be drawn in any order without locking
+	pool->ParallelFor(tiles, 1, [&](size_t begin, size_t end) {
+		for (size_t tile = begin; tile < end; tile++)
+			RasterizeTile((int)tile, forceScalar);
+	});
+}
+
+void OcclusionCuller::RasterizeTile(int tile, bool forceScalar) {
+	int tileX = (tile % tilesX) * tileSize, tileY = (tile / tilesX) * tileSize;
+	for (int y = tileY; y < tileY + tileSize; y++)
+		std::fill(&depth[(size_t)y * width + tileX], &depth[(size_t)y * width + tileX] + tileSize, 1.0f);
+
+	for (unsigned int index : bins[tile])
+	{
+		const Triangle& t = triangles[index];
+		int y0 = std::max(t.minY, tileY), y1 = std::min(t.maxY, tileY + tileSize - 1);
+		int x1 = std::min(t.maxX, tileX + tileSize - 1);
+		for (int y = y0; y <= y1; y++)
+		{
+			float* row = &depth[(size_t)y * width];
+			float py = y + 0.5f;
+			float rowEdge0 = t.edgeB[0] * py + t.edgeC[0];
+			float rowEdge1 = t.edgeB[1] * py + t.edgeC[1];
+			float rowEdge2 = t.edgeB[2] * py + t.edgeC[2];
+			float rowDepth = t.depthB * py + t.depthC;
+			// Pixels outside the triangle fail the edge tests, so whole SIMD groups can start at a group boundary
+			int x = std::max(t.minX, tileX);
+			if (!forceScalar)
+			{
+#if defined(OCCLUSION_AVX2)
+				x &= ~7;
+				__m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+				for (; x <= x1; x += 8)
+				{
+					__m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), offsets);
+					__m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[0]), px), _mm256_set1_ps(rowEdge0));
+					__m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[1]), px), _mm256_set1_ps(rowEdge1));
+					__m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[2]), px), _mm256_set1_ps(rowEdge2));
+					// A pixel is inside when no edge value has its sign bit set
+					__m256 outside = _mm256_or_ps(_mm256_or_ps(e0, e1), e2);
+					__m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.depthA), px), _mm256_set1_ps(rowDepth));
+					__m256 old = _mm256_loadu_ps(row + x);
+					_mm256_storeu_ps(row + x, _mm256_blendv_ps(_mm256_min_ps(old, z), old, outside));
+				}
+#elif defined(OCCLUSION_SSE2)
+				x &= ~3;
+				__m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+				for (; x <= x1; x += 4)
+				{
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+					__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[0]), px), _mm_set1_ps(rowEdge0));
+					__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[1]), px), _mm_set1_ps(rowEdge1));
+					__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[2]), px), _mm_set1_ps(rowEdge2));
+					// Spread each lane's sign bit over the lane to get the outside mask
+					__m128 outside = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(_mm_or_ps(_mm_or_ps(e0, e1), e2)), 31));
+					__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.depthA), px), _mm_set1_ps(rowDepth));
+					__m128 old = _mm_loadu_ps(row + x);
+					__m128 nearer = _mm_min_ps(old, z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(outside, old), _mm_andnot_ps(outside, nearer)));
+				}
+#elif defined(OCCLUSION_NEON)
+				x &= ~3;
+				const float offsetValues[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+				float32x4_t offsets = vld1q_f32(offsetValues);
+				for (; x <= x1; x += 4)
+				{
+					float32x4_t px = vaddq_f32(vdupq_n_f32((float)x), offsets);
+					float32x4_t e0 = vaddq_f32(vmulq_n_f32(px, t.edgeA[0]), vdupq_n_f32(rowEdge0));
+					float32x4_t e1 = vaddq_f32(vmulq_n_f32(px, t.edgeA[1]), vdupq_n_f32(rowEdge1));
+					float32x4_t e2 = vaddq_f32(vmulq_n_f32(px, t.edgeA[2]), vdupq_n_f32(rowEdge2));
+					uint32x4_t outside = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vorrq_u32(vorrq_u32(vreinterpretq_u32_f32(e0), vreinterpretq_u32_f32(e1)), vreinterpretq_u32_f32(e2))), 31));
+					float32x4_t z = vaddq_f32(vmulq_n_f32(px, t.depthA), vdupq_n_f32(rowDepth));
+					float32x4_t old = vld1q_f32(row + x);
+					vst1q_f32(row + x, vbslq_f32(outside, old, vminq_f32(old, z)));
+				}
+#endif
+			}
+			// Same test one pixel at a time, for machines without SIMD
+			for (; x <= x1; x++)
+			{
+				float px = x + 0.5f;
+				float e0 = t.edgeA[0] * px + rowEdge0;
+				float e1 = t.edgeA[1] * px + rowEdge1;
+				float e2 = t.edgeA[2] * px + rowEdge2;
+				if (std::signbit(e0) || std::signbit(e1) || std::signbit(e2))
+					continue;
+				float z = t.depthA * px + rowDepth;
+				row[x] = std::min(row[x], z);
+			}
+		}
+	}
+
+	// Keep the farthest depth of each block, so a test nearer than it is in front of every pixel
+	int blocksX = width / blockSize;
+	for (int by = tileY / blockSize; by < (tileY + tileSize) / blockSize; by++)
+	{
+		for (int bx = tileX / blockSize; bx < (tileX + tileSize) / blockSize; bx++)
+		{
+			float farthest = 0.0f;
+			for (int y = by * blockSize; y < (by + 1) * blockSize; y++)
+			{
+				const float* row = &depth[(size_t)y * width + bx * blockSize];
+				for (int x = 0; x < blockSize; x++)
+					farthest = std::max(farthest, row[x]);
+			}
+			blockDepth[(size_t)by * blocksX + bx] = farthest;
+		}
+	}
+}
+
+bool OcclusionCuller::TestBox(const glm::vec3& low, const glm::vec3& high) const {
+	float minX = (float)width, minY = (float)height, maxX = 0.0f, maxY = 0.0f;
+	float nearest = 1.0f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 p(corner & 1 ? high.x : low.x, corner & 2 ? high.y : low.y, corner & 4 ? high.z : low.z);
+		glm::vec4 clip = viewProj * glm::vec4(p, 1.0f);
+		// Boxes reaching past the near plane are too close to be hidden
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return true;
+		float x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+		float y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+		minX = std::min(minX, x), maxX = std::max(maxX, x);
+		minY = std::min(minY, y), maxY = std::max(maxY, y);
+		nearest = std::min(nearest, clip.z / clip.w * 0.5f + 0.5f);
+	}
+	int x0 = std::max((int)std::floor(minX), 0), x1 = std::min((int)std::floor(maxX), width - 1);
+	int y0 = std::max((int)std::floor(minY), 0), y1 = std::min((int)std::floor(maxY), height - 1);
+	// Boxes off screen are left to the frustum test
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	int blocksX = width / blockSize;
+	for (int by = y0 / blockSize; by <= y1 / blockSize; by++)
+	{
+		for (int bx = x0 / blockSize; bx <= x1 / blockSize; bx++)
+		{
+			if (blockDepth[(size_t)by * blocksX + bx] < nearest)
+				continue;
+			// Some pixel of the block is at least as far as the box, check the ones the box covers
+			for (int y = std::max(y0, by * blockSize); y <= std::min(y1, by * blockSize + blockSize - 1); y++)
+			{
+				for (int x = std::max(x0, bx * blockSize); x <= std::min(x1, bx * blockSize + blockSize - 1); x++)
+				{
+					if (depth[(size_t)y * width + x] >= nearest)
+						return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool OcclusionCuller::TestSphere(const glm::vec3& center, float radius) const {
+	return TestBox(center - glm::vec3(radius), center + glm::vec3(radius));
+}
+
+const char* occlusion_simd_name() {
+#if defined(OCCLUSION_AVX2)
+	return "AVX2";
+#elif defined(OCCLUSION_SSE2)
+	return "SSE2";
+#elif defined(OCCLUSION_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "threadPool.h"
+
+//Class draws a few large occluders into a small CPU depth buffer and tests object bounds against it,
+//so draws hidden behind them can be skipped before any GPU work is spent on them
+//The buffer is split into tiles rasterized in parallel, each keeping the farthest depth of its
+//8x8 pixel blocks so most tests finish without touching single pixels
+//Occluder coverage is sampled at pixel centers; object tests cover every pixel they touch
+class OcclusionCuller
+{
+public:
+	//Size of the depth buffer, rounded up to whole tiles
+	OcclusionCuller(int width = 256, int height = 128);
+
+	//Starts a frame seen through viewProj, forgetting the previous occluders
+	void Begin(const glm::mat4& viewProj);
+	//Adds a triangle mesh that hides what is behind it, placed by model
+	//positions is read every stride bytes, or tightly packed when stride is 0
+	void AddOccluder(const glm::vec3* positions, size_t stride, const GLuint* indices, size_t indexCount, const glm::mat4& model = glm::mat4(1.0f));
+	//Draws the occluders added since Begin, spreading the tiles over a pool when given one
+	void Rasterize(ThreadPool* pool = NULL, bool forceScalar = false);
+
+	//True unless the whole box or sphere is behind the occluders
+	//Safe to call from several threads at once after Rasterize
+	bool TestBox(const glm::vec3& low, const glm::vec3& high) const;
+	bool TestSphere(const glm::vec3& center, float radius) const;
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+	//Depth of each pixel from 0 at the near plane to 1 at the far plane, bottom row first
+	const std::vector<float>& Depth() const { return depth; }
+	size_t TriangleCount() const { return triangles.size(); }
+
+private:
+	//An occluder triangle set up for rasterizing: three edge functions that are positive inside
+	//and a depth plane, all in pixels
+	struct Triangle
+	{
+		float edgeA[3], edgeB[3], edgeC[3];
+		float depthA, depthB, depthC;
+		int minX, minY, maxX, maxY;
+	};
+
+	int width, height;
+	int tilesX, tilesY;
+	glm::mat4 viewProj;
+	std::vector<float> depth;
+	//Farthest depth of each 8x8 block
+	std::vector<float> blockDepth;
+	std::vector<Triangle> triangles;
+	//Triangles overlapping each tile
+	std::vector<std::vector<unsigned int>> bins;
+
+	void AddTriangle(const glm::vec4* clip);
+	void RasterizeTile(int tile, bool forceScalar);
+};
+
+//Name of the instruction set OcclusionCuller rasterizes with
+const char* occlusion_simd_name();
@@ -0,0 +1,20 @@
+// Decoding for the attributes written by pack_mesh (meshPacking.h)
+
+// Bounding box of the mesh, positions arrive as 0..1 within it
+uniform vec3 meshMin;
+uniform vec3 meshSize;
+
+vec3 decodePosition(vec3 packedPosition)
+{
+   return meshMin + packedPosition * meshSize;
+}
+
+// Unfolds a normal stored on an octahedron, arriving as 0..1 unorm16 (PackedLitVertex)
+vec3 decodeNormal(vec2 stored)
+{
+   vec2 encoded = stored * 2.0 - 1.0;
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float t = max(-normal.z, 0.0);
+   normal.xy += vec2(normal.x >= 0.0 ? -t : t, normal.y >= 0.0 ? -t : t);
+   return normalize(normal);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "programCache.h"
+
+#include<chrono>
+#include<cstdio>
+#include<cstring>
+#include<iostream>
+#include<vector>
+
+#include "hash.h"
+#include "mappedFile.h"
+
+//Header written in front of each binary
+struct ProgramCacheHeader
+{
+	char magic[4];
+	GLenum binaryFormat;
+	GLint length;
+	//How long compiling and linking took when the entry was made
+	double compileMs;
+};
+
+ProgramCache::ProgramCache(const char* directory)
+	: directory(directory)
+{
+}
+
+std::string ProgramCache::EntryFor(const std::string& vertexCode, const std::string& fragmentCode) {
+	if (driverHash == 0)
+	{
+		driverHash = hash_string((const char*)glGetString(GL_VENDOR));
+		driverHash = hash_string((const char*)glGetString(GL_RENDERER), driverHash);
+		driverHash = hash_string((const char*)glGetString(GL_VERSION), driverHash);
+	}
+	// Hash the lengths too so moving text between the two stages changes the key
+	size_t lengths[2] = { vertexCode.size(), fragmentCode.size() };
+	unsigned long long hash = hash_bytes(lengths, sizeof(lengths), driverHash);
+	hash = hash_bytes(vertexCode.data(), vertexCode.size(), hash);
+	hash = hash_bytes(fragmentCode.data(), fragmentCode.size(), hash);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", hash);
+	return directory + "/" + name;
+}
+
+bool ProgramCache::Load(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, const char* name) {
+	if (!gl_extensions.programBinary)
+		return false;
+	auto start = std::chrono::steady_clock::now();
+	std::string entry = EntryFor(vertexCode, fragmentCode);
+	MappedFile file;
+	if (!file.Open(entry.c_str()) || file.size < sizeof(ProgramCacheHeader))
+	{
+		misses++;
+		return false;
+	}
+	ProgramCacheHeader header;
+	memcpy(&header, file.data, sizeof(header));
+	if (memcmp(header.magic, "PBIN", 4) != 0 || file.size != sizeof(header) + header.length)
+	{
+		misses++;
+		return false;
+	}
+
+	glProgramBinary(program, header.binaryFormat, file.data + sizeof(header), header.length);
+	// Drivers reject binaries from older versions of themselves, that just means compiling again
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		file.Close();
+		remove(entry.c_str());
+		misses++;
+		return false;
+	}
+
+	double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	hits++;
+	msSaved += header.compileMs - loadMs;
+	std::cout << "PROGRAM_CACHE_HIT for:" << name << " loaded in " << loadMs << " ms, saved " << header.compileMs - loadMs << " ms" << std::endl;
+	return true;
+}
+
+void ProgramCache::PrepareLink(GLuint program) {
+	if (gl_extensions.programBinary)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::Save(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, double compileMs) {
+	if (!gl_extensions.programBinary)
+		return;
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	ProgramCacheHeader header = { { 'P', 'B', 'I', 'N' }, 0, 0, compileMs };
+	std::vector<char> binary(length);
+	glGetProgramBinary(program, length, &header.length, &header.binaryFormat, binary.data());
+
+	make_directories(directory);
+	std::string entry = EntryFor(vertexCode, fragmentCode);
+	// Write beside the entry and rename over it, so a crash part way through never leaves a truncated binary behind
+	std::string temporary = entry + ".tmp";
+	FILE* f = fopen(temporary.c_str(), "wb");
+	if (f == NULL)
+		return;
+	bool written = fwrite(&header, sizeof(header), 1, f) == 1
+		&& fwrite(binary.data(), 1, header.length, f) == (size_t)header.length;
+	written = fclose(f) == 0 && written;
+	// rename will not replace an existing file on Windows; losing the old entry only costs a recompile
+	if (written)
+		remove(entry.c_str());
+	if (!written || rename(temporary.c_str(), entry.c_str()) != 0)
+		remove(temporary.c_str());
+}
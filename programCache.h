@@ -0,0 +1,36 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<string>
+
+#include "glExtensions.h"
+
+//Class stores linked shader programs on disk with glGetProgramBinary so later runs can skip compiling
+//Entries are keyed by the shader sources and the driver's vendor, renderer and version strings,
+//since a binary is only valid for the exact driver that produced it
+class ProgramCache
+{
+public:
+	std::string directory;
+	int hits = 0;
+	int misses = 0;
+	//Compile time saved by hits this run, in milliseconds
+	double msSaved = 0.0;
+
+	ProgramCache(const char* directory);
+
+	//Tries to load a program for these sources into program, returning false if there is no
+	//usable entry (missing, or rejected by the driver after an update); the caller then compiles
+	//Must be called with the OpenGL context current
+	bool Load(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, const char* name);
+	//Call before glLinkProgram on programs that will be saved
+	void PrepareLink(GLuint program);
+	//Saves a linked program along with how long it took to build
+	void Save(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, double compileMs);
+
+private:
+	//Hash of the driver strings, found on first use
+	unsigned long long driverHash = 0;
+
+	std::string EntryFor(const std::string& vertexCode, const std::string& fragmentCode);
+};
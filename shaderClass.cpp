@@ -1,77 +1,290 @@
 #include"shaderClass.h"
 
+#include<algorithm>
+#include<chrono>
+#include<cstring>
+
+#include "hash.h"
+#include "mappedFile.h"
+#include "shaderSource.h"
+#include "UBO.h"
+
 std::string get_file_contents(const char* filename) {
-	std::ifstream in(filename, std::ios::binary);
-	if (in) {
-		std::string contents;
-		in.seekg(0, std::ios::end);
-		contents.resize(in.tellg());
-		in.seekg(0, std::ios::beg);
-		in.read(&contents[0], contents.size());
-		in.close();
-		std::cout << contents << '\n';
-		return contents;
+	MappedFile file;
+	if (file.Open(filename))
+		return std::string((const char*)file.data, file.size);
+	throw(errno);
+}
+
+Shader::Shader(const char* vertexFile, const char* fragmentFile, ProgramCache* cache)
+	: Shader(vertexFile, fragmentFile, std::string(), cache)
+{
+}
+
+Shader::Shader(const char* vertexFile, const char* fragmentFile, const std::string& defines, ProgramCache* cache, bool build)
+	: vertexFile(vertexFile), fragmentFile(fragmentFile), defines(defines), cache(cache)
+{
+	ID = glCreateProgram();
+	// A ShaderCompiler fills the program in later
+	if (!build)
+		return;
 
+	std::string vertexCode, fragmentCode;
+	Sources(vertexCode, fragmentCode);
+
+	//A cached binary replaces the whole compile and link
+	if (cache == NULL || !cache->Load(ID, vertexCode, fragmentCode, vertexFile))
+		Build(ID, vertexCode, fragmentCode, cache);
+	//Look up every uniform once so setting them later needs no string lookups
+	Reflect();
+	ready = true;
+}
+
+bool Shader::Reload() {
+	// A ShaderCompiler owns the program until it has been built
+	if (!ready)
+		return false;
+	std::string vertexCode, fragmentCode;
+	try
+	{
+		Sources(vertexCode, fragmentCode);
 	}
-	throw(errno);
+	catch (int)
+	{
+		// Editors sometimes replace a file by deleting it first, keep the old program and try again later
+		return false;
+	}
+
+	GLuint program = glCreateProgram();
+	if ((cache == NULL || !cache->Load(program, vertexCode, fragmentCode, vertexFile.c_str())) && !Build(program, vertexCode, fragmentCode, cache))
+	{
+		// A broken edit leaves the working program in place
+		glDeleteProgram(program);
+		return false;
+	}
+
+	// Swap the new program in, then give it the values the old one had
+	bool wasActive = active == ID;
+	Delete();
+	ID = program;
+	Reflect();
+	if (wasActive)
+		Activate();
+	for (UniformInfo& info : uniforms)
+	{
+		if (info.set && info.location >= 0)
+			Upload(info);
+	}
+	return true;
 }
 
-Shader::Shader(const char* vertexFile, const char* fragmentFile) {
-	std::string vertexCode = get_file_contents(vertexFile);
-	std::string fragmentCode = get_file_contents(fragmentFile);
+void Shader::Sources(std::string& vertexCode, std::string& fragmentCode) {
+	vertexCode = preprocess_shader(vertexFile.c_str(), defines, vertexSources);
+	fragmentCode = preprocess_shader(fragmentFile.c_str(), defines, fragmentSources);
+}
 
+void Shader::Upload(const UniformInfo& info) {
+	Activate();
+	const unsigned char* value = shadow.data() + info.shadowOffset;
+	const GLfloat* floats = (const GLfloat*)value;
+	switch (info.type)
+	{
+	case GL_FLOAT: glUniform1fv(info.location, 1, floats); break;
+	case GL_FLOAT_VEC2: glUniform2fv(info.location, 1, floats); break;
+	case GL_FLOAT_VEC3: glUniform3fv(info.location, 1, floats); break;
+	case GL_FLOAT_VEC4: glUniform4fv(info.location, 1, floats); break;
+	case GL_FLOAT_MAT4: glUniformMatrix4fv(info.location, 1, GL_FALSE, floats); break;
+	// Ints, bools and samplers are all set with glUniform1i
+	default: glUniform1iv(info.location, 1, (const GLint*)value); break;
+	}
+}
+
+bool Shader::Build(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache) {
+	auto start = std::chrono::steady_clock::now();
+	GLuint vertexShader, fragmentShader;
+	Compile(program, vertexCode, fragmentCode, cache, vertexShader, fragmentShader);
+	return Finish(program, vertexShader, fragmentShader, vertexCode, fragmentCode, cache, start);
+}
+
+void Shader::Compile(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache, GLuint& vertexShader, GLuint& fragmentShader) {
 	//Convert std strings to char arrays
 	const char* vertexSource = vertexCode.c_str();
 	const char* fragmentSource = fragmentCode.c_str();
 
 	//Create a reference to an OpenGL shader. We must tell it the type of shader we want
 	//vertexShader is a reference to the OpenGL vertex shader object that was created for us
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	//Give OpenGL the source code for the shader
 	glShaderSource(vertexShader, 1, &vertexSource, NULL); //Second parm indicates 1 string for the source
 
 	//The GPU cant understand the source code so we have to compile it into machine code
+	//The status is checked in Finish, asking for it here would wait for the compiler
 	glCompileShader(vertexShader);
-	compileErrors(vertexShader, "VERTEX");
 
 	//Do same for fragmentShader as for vertexShader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragmentShader, 1, &fragmentSource, NULL); //Second parm indicates 1 string for the source
 	glCompileShader(fragmentShader);
-	compileErrors(vertexShader, "FRAGMENT");
 
 	//In order to use these shaders, we have to wrap them into a shader program
 	//Note there is only one type of shader program so no need for additional parameters
-	ID = glCreateProgram();
-	glAttachShader(ID, vertexShader);
-	glAttachShader(ID, fragmentShader);
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
 	
 	//Now we need to wrap up the shader program by linking the shaders together into a shader program
-	glLinkProgram(ID);
-	compileErrors(vertexShader, "PROGRAM");
+	if (cache != NULL)
+		cache->PrepareLink(program);
+	glLinkProgram(program);
+}
+
+bool Shader::Finish(GLuint program, GLuint vertexShader, GLuint fragmentShader, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache, std::chrono::steady_clock::time_point start) {
+	compileErrors(vertexShader, "VERTEX", &vertexSources);
+	compileErrors(fragmentShader, "FRAGMENT", &fragmentSources);
+	bool linked = compileErrors(program, "PROGRAM");
 
 	//We can now delete the shaders as they are now in the program itself and will not be needed
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+
+	if (cache != NULL && linked)
+	{
+		double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		cache->Save(program, vertexCode, fragmentCode, compileMs);
+	}
+	return linked;
+}
+
+void Shader::Reflect() {
+	// Programs using the shared per frame data read it from the same binding point
+	GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameData");
+	if (frameBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
+
+	// Slots outlive the program, so after a reload handles still point at the same names
+	for (UniformInfo& info : uniforms)
+		info.location = -1;
+
+	GLint count = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		char name[256];
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(ID, (GLuint)i, sizeof(name), NULL, &size, &type, name);
+		GLint location = glGetUniformLocation(ID, name);
+		// Uniforms in blocks have no location and are not set one by one
+		if (location < 0)
+			continue;
+		// Arrays are reported as "name[0]", make plain "name" find them too
+		char* bracket = strchr(name, '[');
+		if (bracket != NULL)
+			*bracket = '\0';
+
+		unsigned long long hash = hash_string(name);
+		GLint handle = Uniform(name);
+		if (handle < 0)
+		{
+			UniformInfo info;
+			info.hash = hash;
+			// The shadow copy only tracks the first element, which is what the setters write
+			info.shadowOffset = (unsigned int)shadow.size();
+			info.set = false;
+			shadow.resize(shadow.size() + sizeof(glm::mat4));
+			handle = (GLint)uniforms.size();
+			uniforms.push_back(info);
+			// Sorted by hash so lookups are a binary search over a small flat array
+			auto at = std::lower_bound(lookup.begin(), lookup.end(), hash, [](const std::pair<unsigned long long, GLint>& entry, unsigned long long h) { return entry.first < h; });
+			lookup.insert(at, std::make_pair(hash, handle));
+		}
+		else if (uniforms[handle].type != type)
+		{
+			// The type changed in an edit, so the old value can not be reused
+			uniforms[handle].set = false;
+		}
+		uniforms[handle].location = location;
+		uniforms[handle].type = type;
+	}
+}
+
+GLint Shader::Uniform(const char* name) {
+	unsigned long long hash = hash_string(name);
+	auto it = std::lower_bound(lookup.begin(), lookup.end(), hash, [](const std::pair<unsigned long long, GLint>& entry, unsigned long long h) { return entry.first < h; });
+	if (it == lookup.end() || it->first != hash)
+		return -1;
+	return it->second;
 }
 
+bool Shader::Changed(GLint handle, const void* value, size_t size) {
+	if (handle < 0)
+		return false;
+	UniformInfo& info = uniforms[handle];
+	unsigned char* copy = shadow.data() + info.shadowOffset;
+	if (info.set && memcmp(copy, value, size) == 0)
+		return false;
+	memcpy(copy, value, size);
+	info.set = true;
+	if (info.location < 0)
+		return false;
+	// glUniform writes to whichever program is in use
+	Activate();
+	return true;
+}
+
+void Shader::set(GLint handle, int value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniform1i(uniforms[handle].location, value);
+}
+
+void Shader::set(GLint handle, float value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniform1f(uniforms[handle].location, value);
+}
+
+void Shader::set(GLint handle, const glm::vec2& value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniform2fv(uniforms[handle].location, 1, glm::value_ptr(value));
+}
+
+void Shader::set(GLint handle, const glm::vec3& value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniform3fv(uniforms[handle].location, 1, glm::value_ptr(value));
+}
+
+void Shader::set(GLint handle, const glm::vec4& value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniform4fv(uniforms[handle].location, 1, glm::value_ptr(value));
+}
+
+void Shader::set(GLint handle, const glm::mat4& value) {
+	if (Changed(handle, &value, sizeof(value)))
+		glUniformMatrix4fv(uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+GLuint Shader::active = 0;
+
 void Shader::Activate() {
-	//Activate the shader program
+	//Activate the shader program, unless it already is
+	if (active == ID)
+		return;
 	glUseProgram(ID);
+	active = ID;
 }
 
-void Shader::compileErrors(unsigned int shader, const char* type) {
+bool Shader::compileErrors(unsigned int shader, const char* type, const std::vector<std::string>* files) {
 	// Stores status of compilation
 	GLint hasCompiled;
 	// Character array to store error message in
 	char infoLog[1024];
-	if (type != "PROGRAM")
+	if (strcmp(type, "PROGRAM") != 0)
 	{
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &hasCompiled);
 		if (hasCompiled == GL_FALSE)
 		{
 			glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-			std::cout << "SHADER_COMPILATION_ERROR for:" << type << "\n" << infoLog << std::endl;
+			// Show file names instead of the source string numbers of included files
+			std::string log = files != NULL ? map_shader_log(infoLog, *files) : std::string(infoLog);
+			std::cout << "SHADER_COMPILATION_ERROR for:" << type << "\n" << log << std::endl;
 		}
 	}
 	else
@@ -83,8 +296,11 @@ void Shader::compileErrors(unsigned int shader, const char* type) {
 			std::cout << "SHADER_LINKING_ERROR for:" << type << "\n" << infoLog << std::endl;
 		}
 	}
+	return hasCompiled == GL_TRUE;
 }
 
 void Shader::Delete() {
+	if (active == ID)
+		active = 0;
 	glDeleteProgram(ID);
 }
\ No newline at end of file
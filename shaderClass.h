@@ -6,8 +6,15 @@
 #include<sstream>
 #include<iostream>
 #include<cerrno>
+#include<vector>
+#include<chrono>
+#include<glm/glm/glm.hpp>
+#include<glm/glm/gtc/type_ptr.hpp>
+
+#include "programCache.h"
 
 //Function to read the shader text files
+//Shaders themselves are read through preprocess_shader, which also resolves #include
 std::string get_file_contents(const char* filename);
 
 //Class produces an OpenGL shader program that is nicely wrapped up
@@ -15,12 +22,79 @@ class Shader
 {
 public:
 	GLuint ID;
-	Shader(const char* vertexFile, const char* fragmentFile);
+	std::string vertexFile;
+	std::string fragmentFile;
+	//Lines inserted after #version in both stages, used to select shader variants
+	std::string defines;
+	//Every file each stage was built from, indexed by GLSL source string number
+	std::vector<std::string> vertexSources;
+	std::vector<std::string> fragmentSources;
+	//With a cache, a program binary from an earlier run is used instead of compiling when possible
+	Shader(const char* vertexFile, const char* fragmentFile, ProgramCache* cache = NULL);
+	//Builds the shader with #define lines placed after the #version line of each stage
+	//With build false only the program object is made, and a ShaderCompiler builds it later
+	Shader(const char* vertexFile, const char* fragmentFile, const std::string& defines, ProgramCache* cache = NULL, bool build = true);
+	//False until the program has been built, the shader must not be used before then
+	bool ready = false;
 
 	void Activate();
 	void Delete();
+	//Rebuilds the program from its files, keeping the old one if the new one fails to compile
+	//Uniform handles stay valid and uniforms keep the values they were last set to
+	bool Reload();
+
+	//Finds the handle of an active uniform, or -1 if the program does not use it
+	//Look handles up once and keep them, setting by handle skips the name lookup
+	GLint Uniform(const char* name);
+	//Sets a uniform, skipping the upload if it already holds this value
+	void set(GLint handle, int value);
+	void set(GLint handle, float value);
+	void set(GLint handle, const glm::vec2& value);
+	void set(GLint handle, const glm::vec3& value);
+	void set(GLint handle, const glm::vec4& value);
+	void set(GLint handle, const glm::mat4& value);
+	template<typename T>
+	void set(const char* name, const T& value) { set(Uniform(name), value); }
 
 private:
-	void compileErrors(unsigned int shader, const char* type);
+	friend class ShaderCompiler;
+
+	//An active uniform found when the program was linked
+	struct UniformInfo
+	{
+		unsigned long long hash;
+		GLint location;
+		GLenum type;
+		//Where the last value sent lives in shadow
+		unsigned int shadowOffset;
+		bool set;
+	};
+	ProgramCache* cache;
+	//Indexed by handle, entries are never removed so handles survive a Reload
+	std::vector<UniformInfo> uniforms;
+	//Name hash to handle, sorted by hash
+	std::vector<std::pair<unsigned long long, GLint>> lookup;
+	//Copies of the last value sent to each uniform
+	std::vector<unsigned char> shadow;
+	//Program in use, so Activate can skip redundant glUseProgram calls
+	static GLuint active;
+
+	//Reads both stages from their files, expanding includes and inserting the defines
+	void Sources(std::string& vertexCode, std::string& fragmentCode);
+	//Compiles and links sources into program, returning false on failure
+	bool Build(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache);
+	//Starts compiling and linking without asking for any status, so the driver is free to work in the background
+	static void Compile(GLuint program, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache, GLuint& vertexShader, GLuint& fragmentShader);
+	//Waits for a program started with Compile, reports errors, frees the shader objects and saves it to the cache
+	bool Finish(GLuint program, GLuint vertexShader, GLuint fragmentShader, const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache, std::chrono::steady_clock::time_point start);
+	//Reads the active uniforms of the linked program and binds its FrameData block
+	void Reflect();
+	//Sends a uniform's shadow copy to the program
+	void Upload(const UniformInfo& info);
+	//Updates the shadow copy, returning true (with the program active) if the value is new
+	bool Changed(GLint handle, const void* value, size_t size);
+	//Prints the log and returns false if compiling or linking failed
+	//A stage's file list turns the source string numbers in its log into file names
+	bool compileErrors(unsigned int shader, const char* type, const std::vector<std::string>* files = NULL);
 
 };
@@ -0,0 +1,156 @@
+#include "shaderCompiler.h"
+
+#include<algorithm>
+
+#include "glExtensions.h"
+
+ShaderCompiler::ShaderCompiler(GLFWwindow* window, unsigned int threads)
+	: window(window)
+{
+	if (gl_extensions.parallelShaderCompile)
+	{
+		// Let the driver use as many compiler threads as it likes
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		return;
+	}
+
+	if (threads == 0)
+		threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+	// Windows have to be made on the main thread; the hints of the main window are still set,
+	// so the shared contexts get the same version and profile
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		GLFWwindow* context = glfwCreateWindow(1, 1, "", NULL, window);
+		if (context == NULL)
+			break;
+		contexts.push_back(context);
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	freeContexts = contexts;
+	if (!contexts.empty())
+		pool.reset(new ThreadPool((unsigned int)contexts.size()));
+}
+
+void ShaderCompiler::Submit(Shader& shader) {
+	Pending entry;
+	entry.shader = &shader;
+	shader.Sources(entry.vertexCode, entry.fragmentCode);
+	entry.start = std::chrono::steady_clock::now();
+
+	// A cached binary loads quickly enough to do right here
+	if (shader.cache != NULL && shader.cache->Load(shader.ID, entry.vertexCode, entry.fragmentCode, shader.vertexFile.c_str()))
+	{
+		shader.Reflect();
+		shader.ready = true;
+		return;
+	}
+
+	if (pool)
+	{
+		GLuint program = shader.ID;
+		ProgramCache* cache = shader.cache;
+		std::string vertexCode = entry.vertexCode;
+		std::string fragmentCode = entry.fragmentCode;
+		entry.compiled = pool->Submit([this, program, cache, vertexCode, fragmentCode]() {
+			GLFWwindow* context;
+			{
+				std::lock_guard<std::mutex> lock(contextMutex);
+				context = freeContexts.back();
+				freeContexts.pop_back();
+			}
+			glfwMakeContextCurrent(context);
+			GLuint vertexShader, fragmentShader;
+			Shader::Compile(program, vertexCode, fragmentCode, cache, vertexShader, fragmentShader);
+			// The status query waits for the link, and glFinish makes the results visible to the main context
+			GLint linked;
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			glFinish();
+			glfwMakeContextCurrent(NULL);
+			{
+				std::lock_guard<std::mutex> lock(contextMutex);
+				freeContexts.push_back(context);
+			}
+			return std::make_pair(vertexShader, fragmentShader);
+		});
+	}
+	else
+	{
+		// Issue everything now and ask for the status later, drivers that compile in the
+		// background (with or without the extension) then overlap the programs
+		Shader::Compile(shader.ID, entry.vertexCode, entry.fragmentCode, shader.cache, entry.vertexShader, entry.fragmentShader);
+	}
+	pending.push_back(std::move(entry));
+}
+
+bool ShaderCompiler::Done(Pending& entry) {
+	if (entry.compiled.valid())
+		return entry.compiled.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	if (gl_extensions.parallelShaderCompile)
+	{
+		GLint done = GL_FALSE;
+		glGetProgramiv(entry.shader->ID, GL_COMPLETION_STATUS_KHR, &done);
+		return done == GL_TRUE;
+	}
+	return true;
+}
+
+void ShaderCompiler::Finish(Pending& entry) {
+	if (entry.compiled.valid())
+	{
+		std::pair<GLuint, GLuint> shaders = entry.compiled.get();
+		entry.vertexShader = shaders.first;
+		entry.fragmentShader = shaders.second;
+	}
+	Shader& shader = *entry.shader;
+	shader.Finish(shader.ID, entry.vertexShader, entry.fragmentShader, entry.vertexCode, entry.fragmentCode, shader.cache, entry.start);
+	shader.Reflect();
+	shader.ready = true;
+}
+
+void ShaderCompiler::Update() {
+	for (size_t i = 0; i < pending.size();)
+	{
+		if (Done(pending[i]))
+		{
+			Finish(pending[i]);
+			pending[i] = std::move(pending.back());
+			pending.pop_back();
+		}
+		else
+			i++;
+	}
+}
+
+void ShaderCompiler::Wait(Shader& shader) {
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		if (pending[i].shader == &shader)
+		{
+			Finish(pending[i]);
+			pending[i] = std::move(pending.back());
+			pending.pop_back();
+			return;
+		}
+	}
+}
+
+void ShaderCompiler::WaitAll() {
+	for (Pending& entry : pending)
+		Finish(entry);
+	pending.clear();
+}
+
+bool ShaderCompiler::Busy() {
+	return !pending.empty();
+}
+
+void ShaderCompiler::Delete() {
+	WaitAll();
+	if (pool)
+		pool->Delete();
+	for (GLFWwindow* context : contexts)
+		glfwDestroyWindow(context);
+	contexts.clear();
+	freeContexts.clear();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<GLFW/glfw3.h>
+#include<chrono>
+#include<future>
+#include<mutex>
+#include<string>
+#include<vector>
+
+#include "shaderClass.h"
+#include "threadPool.h"
+
+//Class builds many shader programs at once instead of one after the other
+//With KHR_parallel_shader_compile the driver compiles on its own threads and programs are polled
+//with GL_COMPLETION_STATUS_KHR; without it, hidden windows sharing the main context compile on a
+//thread pool. Loading time then follows the number of compiler threads rather than the program count
+class ShaderCompiler
+{
+public:
+	//Must be created on the main thread with window's context current
+	//threads is how many shared contexts to make when the driver has no parallel compile, zero picks for us
+	ShaderCompiler(GLFWwindow* window, unsigned int threads = 0);
+
+	//Starts building a shader made with build set to false
+	//Programs found in the shader's cache are ready right away
+	void Submit(Shader& shader);
+	//Finishes every program whose build is done, making those shaders ready
+	//Must be called on the thread that owns the OpenGL context
+	void Update();
+	//Finishes one shader now, waiting for the compiler if needed
+	void Wait(Shader& shader);
+	//Finishes every submitted shader
+	void WaitAll();
+	//True while any submitted shader is not ready
+	bool Busy();
+	//Waits for outstanding builds and destroys the shared contexts
+	void Delete();
+
+private:
+	struct Pending
+	{
+		Shader* shader;
+		std::string vertexCode;
+		std::string fragmentCode;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		std::chrono::steady_clock::time_point start;
+		//Set when a worker context builds the program, holds the vertex and fragment shader objects
+		std::future<std::pair<GLuint, GLuint>> compiled;
+	};
+
+	GLFWwindow* window;
+	std::vector<Pending> pending;
+	//Shared contexts not currently used by a worker
+	std::vector<GLFWwindow*> contexts;
+	std::vector<GLFWwindow*> freeContexts;
+	std::mutex contextMutex;
+	//Only created when compiling on shared contexts
+	std::unique_ptr<ThreadPool> pool;
+
+	//True once the program no longer needs the compiler, so finishing it will not stall
+	bool Done(Pending& entry);
+	void Finish(Pending& entry);
+};
@@ -0,0 +1,241 @@
+#include "shaderSource.h"
+
+#include<cerrno>
+#include<cctype>
+#include<cstring>
+#include<iostream>
+#include<mutex>
+#include<unordered_map>
+#include<unordered_set>
+
+#include "mappedFile.h"
+
+//A file split at its #include and #version lines
+struct SourceChunk
+{
+	enum Kind { Text, Include, Version };
+	struct Segment
+	{
+		Kind kind;
+		//The text itself, or the resolved path of an include
+		std::string text;
+		//Line in the file the segment starts on
+		unsigned int line;
+	};
+	FileStamp stamp;
+	std::vector<Segment> segments;
+};
+
+//Parsed files by path, shared by every shader
+static std::unordered_map<std::string, SourceChunk> chunks;
+static std::mutex chunkMutex;
+
+//Length of the part of a path that makes it absolute: a leading separator, a drive like "C:" or both
+static size_t root_length(const std::string& path) {
+	size_t length = 0;
+	if (path.size() >= 2 && isalpha((unsigned char)path[0]) && path[1] == ':')
+		length = 2;
+	if (length < path.size() && (path[length] == '/' || path[length] == '\\'))
+		length++;
+	return length;
+}
+
+//Joins an include to the directory of the file including it, folding "./" and "dir/../"
+//Absolute includes are used as they are, and an absolute result keeps its root
+static std::string resolve_include(const std::string& from, const std::string& name) {
+	size_t slash = from.find_last_of("/\\");
+	std::string path = slash == std::string::npos || root_length(name) > 0 ? name : from.substr(0, slash + 1) + name;
+	size_t root = root_length(path);
+	std::vector<std::string> parts;
+	size_t start = root;
+	while (start <= path.size())
+	{
+		size_t end = path.find_first_of("/\\", start);
+		if (end == std::string::npos)
+			end = path.size();
+		std::string part = path.substr(start, end - start);
+		if (part == "..")
+		{
+			if (!parts.empty() && parts.back() != "..")
+				parts.pop_back();
+			// Nothing is above the root of an absolute path
+			else if (root == 0)
+				parts.push_back(part);
+		}
+		else if (part != "." && !part.empty())
+			parts.push_back(part);
+		start = end + 1;
+	}
+	std::string resolved;
+	for (const std::string& part : parts)
+		resolved += resolved.empty() ? part : "/" + part;
+	// The root's separator is written as "/" like the others, so both spellings give one path
+	std::string prefix = path.substr(0, root);
+	if (!prefix.empty() && prefix.back() == '\\')
+		prefix.back() = '/';
+	return prefix + resolved;
+}
+
+//Checks if a line is a directive, returning where its argument starts
+static bool is_directive(const char* line, const char* end, const char* directive, const char*& argument) {
+	while (line < end && (*line == ' ' || *line == '\t'))
+		line++;
+	if (line == end || *line++ != '#')
+		return false;
+	while (line < end && (*line == ' ' || *line == '\t'))
+		line++;
+	size_t length = strlen(directive);
+	if ((size_t)(end - line) < length || strncmp(line, directive, length) != 0)
+		return false;
+	argument = line + length;
+	return true;
+}
+
+static const SourceChunk& parse_chunk(const std::string& path) {
+	FileStamp stamp = file_stamp(path.c_str());
+	auto it = chunks.find(path);
+	if (it != chunks.end() && it->second.stamp == stamp)
+		return it->second;
+
+	MappedFile file;
+	if (!file.Open(path.c_str()))
+	{
+		std::cout << "SHADER_SOURCE_ERROR can not read:" << path << std::endl;
+		throw(errno ? errno : ENOENT);
+	}
+	SourceChunk chunk;
+	chunk.stamp = stamp;
+	const char* text = (const char*)file.data;
+	const char* end = text + file.size;
+	unsigned int lineNumber = 1;
+	for (const char* line = text; line < end; lineNumber++)
+	{
+		const char* next = (const char*)memchr(line, '\n', end - line);
+		next = next == NULL ? end : next + 1;
+		const char* argument;
+		SourceChunk::Segment segment;
+		segment.line = lineNumber;
+		if (is_directive(line, next, "include", argument))
+		{
+			const char* open = (const char*)memchr(argument, '"', next - argument);
+			const char* close = open == NULL ? NULL : (const char*)memchr(open + 1, '"', next - open - 1);
+			if (close == NULL)
+			{
+				std::cout << "SHADER_SOURCE_ERROR bad #include in " << path << "(" << lineNumber << ")" << std::endl;
+				throw(EINVAL);
+			}
+			segment.kind = SourceChunk::Include;
+			segment.text = resolve_include(path, std::string(open + 1, close));
+			chunk.segments.push_back(segment);
+		}
+		else if (is_directive(line, next, "version", argument))
+		{
+			segment.kind = SourceChunk::Version;
+			segment.text.assign(line, next);
+			chunk.segments.push_back(segment);
+		}
+		else if (!chunk.segments.empty() && chunk.segments.back().kind == SourceChunk::Text)
+			chunk.segments.back().text.append(line, next);
+		else
+		{
+			segment.kind = SourceChunk::Text;
+			segment.text.assign(line, next);
+			chunk.segments.push_back(segment);
+		}
+		line = next;
+	}
+	return chunks[path] = std::move(chunk);
+}
+
+static void expand(const std::string& path, const std::string& defines, std::string& out, std::vector<std::string>& files, std::unordered_set<std::string>& included) {
+	unsigned int index = (unsigned int)files.size();
+	files.push_back(path);
+	// Map entries stay put when others are added, and each path is expanded once so it is not reparsed under us
+	const SourceChunk& chunk = parse_chunk(path);
+	// Everything but the start of the root file needs its position restated
+	bool needLine = index != 0;
+	// A root file without #version gets its defines up front instead of after that line
+	if (index == 0 && !defines.empty())
+	{
+		bool hasVersion = false;
+		for (const SourceChunk::Segment& segment : chunk.segments)
+			hasVersion = hasVersion || segment.kind == SourceChunk::Version;
+		if (!hasVersion)
+		{
+			out += defines;
+			needLine = true;
+		}
+	}
+	for (const SourceChunk::Segment& segment : chunk.segments)
+	{
+		switch (segment.kind)
+		{
+		case SourceChunk::Text:
+			if (needLine)
+				out += "#line " + std::to_string(segment.line) + " " + std::to_string(index) + "\n";
+			out += segment.text;
+			needLine = false;
+			break;
+		case SourceChunk::Include:
+			if (included.insert(segment.text).second)
+				expand(segment.text, defines, out, files, included);
+			needLine = true;
+			break;
+		case SourceChunk::Version:
+			out += segment.text;
+			if (!segment.text.empty() && segment.text.back() != '\n')
+				out += '\n';
+			if (index == 0 && !defines.empty())
+			{
+				out += defines;
+				needLine = true;
+			}
+			break;
+		}
+	}
+	// Keep the next chunk from being glued onto a last line without a newline
+	if (!out.empty() && out.back() != '\n')
+		out += '\n';
+}
+
+std::string preprocess_shader(const char* filename, const std::string& defines, std::vector<std::string>& files) {
+	std::lock_guard<std::mutex> lock(chunkMutex);
+	files.clear();
+	std::string root = resolve_include("", filename);
+	std::unordered_set<std::string> included;
+	included.insert(root);
+	std::string out;
+	expand(root, defines, out, files, included);
+	return out;
+}
+
+std::string map_shader_log(const std::string& log, const std::vector<std::string>& files) {
+	std::string mapped;
+	size_t start = 0;
+	while (start < log.size())
+	{
+		size_t end = log.find('\n', start);
+		end = end == std::string::npos ? log.size() : end + 1;
+		std::string line = log.substr(start, end - start);
+		// The first number directly followed by "(" or ":" and another number is the source string
+		for (size_t i = 0; i < line.size(); i++)
+		{
+			if (!isdigit((unsigned char)line[i]) || (i > 0 && isdigit((unsigned char)line[i - 1])))
+				continue;
+			size_t digits = i;
+			while (digits < line.size() && isdigit((unsigned char)line[digits]))
+				digits++;
+			if (digits + 1 < line.size() && (line[digits] == '(' || line[digits] == ':') && isdigit((unsigned char)line[digits + 1]))
+			{
+				size_t index = (size_t)std::stoul(line.substr(i, digits - i));
+				if (index < files.size())
+					line.replace(i, digits - i, files[index]);
+				break;
+			}
+			i = digits;
+		}
+		mapped += line;
+		start = end;
+	}
+	return mapped;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+//Reads a shader stage and expands its #include "file" lines into one source string
+//Paths are relative to the including file and every file is pasted in at most once, so shared
+//headers need no include guards. Files are mapped rather than streamed and kept parsed, keyed by
+//path and modification time, so many shaders sharing a library only read each file once
+//defines are placed after the #version line. Every file gets a GLSL source string number (the
+//root is 0) and #line directives keep line numbers those of the real files; files receives the
+//file names by number, for map_shader_log and for watching
+//Throws errno if a file can not be read, like get_file_contents
+std::string preprocess_shader(const char* filename, const std::string& defines, std::vector<std::string>& files);
+
+//Rewrites the source string numbers at the start of each line of a compile log into file names
+//Handles the "0(12)" and "0:12" styles drivers use
+std::string map_shader_log(const std::string& log, const std::vector<std::string>& files);
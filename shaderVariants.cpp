@@ -0,0 +1,61 @@
+#include "shaderVariants.h"
+
+static const char* featureNames[] = { "VERTEX_COLOR", "TEXTURE", "FOG", "INSTANCING", "PACKED_VERTICES", "ATLAS" };
+
+std::string variant_defines(ShaderKey key)
+{
+	std::string defines;
+	for (unsigned int bit = 0; bit < sizeof(featureNames) / sizeof(featureNames[0]); bit++)
+	{
+		if (key & (1u << bit))
+		{
+			defines += "#define ";
+			defines += featureNames[bit];
+			defines += " 1\n";
+		}
+	}
+	return defines;
+}
+
+ShaderVariants::ShaderVariants(const char* vertexFile, const char* fragmentFile, ProgramCache* cache, ShaderCompiler* compiler)
+	: vertexFile(vertexFile), fragmentFile(fragmentFile), cache(cache), compiler(compiler)
+{
+}
+
+Shader& ShaderVariants::Start(ShaderKey key)
+{
+	auto it = variants.find(key);
+	if (it != variants.end())
+		return *it->second;
+
+	bool build = compiler == NULL;
+	std::unique_ptr<Shader> shader(new Shader(vertexFile.c_str(), fragmentFile.c_str(), variant_defines(key), cache, build));
+	Shader& variant = *shader;
+	variants.emplace(key, std::move(shader));
+	if (!build)
+		compiler->Submit(variant);
+	return variant;
+}
+
+Shader& ShaderVariants::Variant(ShaderKey key)
+{
+	Shader& variant = Start(key);
+	if (!variant.ready)
+		compiler->Wait(variant);
+	return variant;
+}
+
+std::vector<Shader*> ShaderVariants::Shaders() const
+{
+	std::vector<Shader*> shaders;
+	for (auto& variant : variants)
+		shaders.push_back(variant.second.get());
+	return shaders;
+}
+
+void ShaderVariants::Delete()
+{
+	for (auto& variant : variants)
+		variant.second->Delete();
+	variants.clear();
+}
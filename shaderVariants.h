@@ -0,0 +1,101 @@
+#pragma once
+
+#include<string>
+#include<unordered_map>
+#include<memory>
+#include<vector>
+
+#include "shaderClass.h"
+#include "shaderCompiler.h"
+
+//Bitmask naming the features compiled into a shader variant
+typedef unsigned int ShaderKey;
+
+//Features a variant can be built with, each one turns on a #define of the same name in caps
+namespace ShaderFeature
+{
+	enum : ShaderKey
+	{
+		//Multiplies in the per vertex color (VERTEX_COLOR)
+		VertexColor = 1u << 0,
+		//Samples tex0 (TEXTURE)
+		Texture = 1u << 1,
+		//Blends towards fogColor with distance (FOG)
+		Fog = 1u << 2,
+		//Offsets each instance by the per instance attribute at location 3 (INSTANCING)
+		Instancing = 1u << 3,
+		//Reads the quantized attributes of pack_mesh, with the bounding box in meshMin and meshSize (PACKED_VERTICES)
+		PackedVertices = 1u << 4,
+		//Samples tex0 as a TextureAtlas array at the per vertex layer of location 5 (ATLAS)
+		Atlas = 1u << 5,
+		All = VertexColor | Texture | Fog | Instancing | PackedVertices | Atlas
+	};
+}
+
+//True if a variant with these features can be built
+//Every variant needs somewhere to get its color from, and an atlas only changes how the texture is sampled
+constexpr bool valid_variant(ShaderKey key)
+{
+	return (key & ~ShaderKey(ShaderFeature::All)) == 0
+		&& (key & (ShaderFeature::VertexColor | ShaderFeature::Texture)) != 0
+		&& ((key & ShaderFeature::Atlas) == 0 || (key & ShaderFeature::Texture) != 0);
+}
+
+//The #define lines for a variant, inserted right after the #version line
+std::string variant_defines(ShaderKey key);
+
+//Class builds variants of one vertex/fragment pair from a feature bitmask
+//Keys are template arguments so an invalid combination fails to compile instead of failing at run time
+//Variants are compiled the first time they are asked for and kept by key
+class ShaderVariants
+{
+public:
+	std::string vertexFile;
+	std::string fragmentFile;
+
+	//With a compiler, prewarmed variants build in parallel in the background
+	ShaderVariants(const char* vertexFile, const char* fragmentFile, ProgramCache* cache = NULL, ShaderCompiler* compiler = NULL);
+
+	//Returns the variant, compiling it now if this is the first request
+	//or waiting for it if it is still being prewarmed
+	//The reference stays valid until Delete
+	template<ShaderKey Key>
+	Shader& Get()
+	{
+		static_assert(valid_variant(Key), "Invalid shader feature combination");
+		return Variant(Key);
+	}
+	//Compiles the listed variants up front, e.g. behind a loading screen,
+	//so the first frame that uses them does not stall on the compiler
+	//With a compiler this returns at once; the variants are ready once the compiler is no longer busy
+	template<ShaderKey... Keys>
+	void Prewarm()
+	{
+		const ShaderKey keys[] = { Checked<Keys>::key... };
+		for (ShaderKey key : keys)
+			Start(key);
+	}
+	//Number of variants compiled so far
+	size_t Size() const { return variants.size(); }
+	//Every variant made so far, including ones still being prewarmed
+	std::vector<Shader*> Shaders() const;
+	void Delete();
+
+private:
+	template<ShaderKey Key>
+	struct Checked
+	{
+		static_assert(valid_variant(Key), "Invalid shader feature combination");
+		static const ShaderKey key = Key;
+	};
+
+	ProgramCache* cache;
+	ShaderCompiler* compiler;
+	//Shaders are kept behind pointers so watchers and callers can hold on to them
+	std::unordered_map<ShaderKey, std::unique_ptr<Shader>> variants;
+
+	//Creates the variant if it does not exist yet, handing it to the compiler when there is one
+	Shader& Start(ShaderKey key);
+	//Creates the variant if needed and makes sure it is ready
+	Shader& Variant(ShaderKey key);
+};
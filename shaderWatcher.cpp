@@ -0,0 +1,169 @@
+#include "shaderWatcher.h"
+
+#include<algorithm>
+#include<chrono>
+
+#include "mappedFile.h"
+#include "shaderVariants.h"
+
+#ifdef __linux__
+#include<sys/inotify.h>
+#include<unistd.h>
+#include<fcntl.h>
+#endif
+
+//Splits a path into its directory and file name
+static void splitPath(const std::string& path, std::string& directory, std::string& name) {
+	size_t slash = path.find_last_of("/\\");
+	directory = slash == std::string::npos ? "." : path.substr(0, slash);
+	name = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+ShaderWatcher::ShaderWatcher() {
+#ifdef __linux__
+	// Non-blocking, so Update never waits when nothing changed
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+std::string ShaderWatcher::Track(const std::string& file) {
+	std::string directory, name;
+	splitPath(file, directory, name);
+#ifdef __linux__
+	// Editors often save by writing a new file and renaming it over the old one, which
+	// would drop a watch on the file itself, so the directory is watched instead
+	bool known = false;
+	for (auto& d : directories)
+		known = known || d.second == directory;
+	if (!known && inotifyFd >= 0)
+	{
+		int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (wd >= 0)
+			directories.push_back(std::make_pair(wd, directory));
+	}
+#endif
+	return directory + "/" + name;
+}
+
+void ShaderWatcher::Watch(Shader& shader) {
+	Watched w;
+	w.shader = &shader;
+	Files(w);
+	watched.push_back(w);
+}
+
+void ShaderWatcher::Watch(ShaderVariants& variants) {
+	variantSets.push_back(&variants);
+	Adopt();
+}
+
+void ShaderWatcher::Adopt() {
+	for (ShaderVariants* variants : variantSets)
+	{
+		for (Shader* shader : variants->Shaders())
+		{
+			if (!shader->ready)
+				continue;
+			bool known = false;
+			for (const Watched& w : watched)
+				known = known || w.shader == shader;
+			if (!known)
+				Watch(*shader);
+		}
+	}
+}
+
+void ShaderWatcher::Files(Watched& w) {
+	// Included files count too; before the shader is built only its two stages are known
+	std::vector<std::string> files = w.shader->vertexSources;
+	files.insert(files.end(), w.shader->fragmentSources.begin(), w.shader->fragmentSources.end());
+	if (files.empty())
+		files = { w.shader->vertexFile, w.shader->fragmentFile };
+	w.files.clear();
+	w.stamps.clear();
+	for (const std::string& file : files)
+	{
+		std::string tracked = Track(file);
+		if (std::find(w.files.begin(), w.files.end(), tracked) != w.files.end())
+			continue;
+		w.files.push_back(tracked);
+		w.stamps.push_back(file_stamp(tracked.c_str()));
+	}
+}
+
+void ShaderWatcher::Update() {
+	Adopt();
+	std::vector<std::string> changed;
+#ifdef __linux__
+	if (inotifyFd < 0)
+		return;
+	alignas(inotify_event) char buffer[4096];
+	while (true)
+	{
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+		for (char* p = buffer; p < buffer + length;)
+		{
+			inotify_event* event = (inotify_event*)p;
+			for (auto& d : directories)
+			{
+				if (d.first == event->wd && event->len > 0)
+					changed.push_back(d.second + "/" + event->name);
+			}
+			p += sizeof(inotify_event) + event->len;
+		}
+	}
+#else
+	double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	if (now - lastPoll < 0.5)
+		return;
+	lastPoll = now;
+	for (Watched& w : watched)
+	{
+		for (size_t i = 0; i < w.files.size(); i++)
+		{
+			FileStamp stamp = file_stamp(w.files[i].c_str());
+			if (stamp != w.stamps[i])
+			{
+				w.stamps[i] = stamp;
+				changed.push_back(w.files[i]);
+			}
+		}
+	}
+#endif
+	if (changed.empty())
+		return;
+
+	for (Watched& w : watched)
+	{
+		bool dirty = false;
+		for (const std::string& file : w.files)
+		{
+			for (const std::string& c : changed)
+				dirty = dirty || c == file;
+		}
+		if (!dirty)
+			continue;
+		auto start = std::chrono::steady_clock::now();
+		bool reloaded = w.shader->Reload();
+		// The edit may have added or removed includes
+		Files(w);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (reloaded)
+			std::cout << "SHADER_RELOADED for:" << w.shader->vertexFile << " in " << ms << " ms" << std::endl;
+		else
+			std::cout << "SHADER_RELOAD_FAILED for:" << w.shader->vertexFile << ", keeping the previous program" << std::endl;
+	}
+}
+
+void ShaderWatcher::Delete() {
+#ifdef __linux__
+	if (inotifyFd >= 0)
+		close(inotifyFd);
+	inotifyFd = -1;
+	directories.clear();
+#endif
+	watched.clear();
+	variantSets.clear();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+#include "shaderClass.h"
+#include "mappedFile.h"
+
+class ShaderVariants;
+
+//Class watches the source files of shaders during development and reloads
+//a shader as soon as one of its files is saved
+//On Linux changes come from inotify, elsewhere file times are polled twice a second
+//Reloading is deferred to Update on the OpenGL thread; a failed compile keeps the old program
+class ShaderWatcher
+{
+public:
+	ShaderWatcher();
+
+	//Starts watching a shader's vertex and fragment files and the files they include
+	void Watch(Shader& shader);
+	//Watches every variant of a set, including variants first asked for later
+	//Variants are picked up by Update once they are built, so a reload never races the compiler
+	void Watch(ShaderVariants& variants);
+	//Reloads the shaders whose files changed since the last call
+	//Must be called on the thread that owns the OpenGL context
+	void Update();
+	void Delete();
+
+private:
+	struct Watched
+	{
+		Shader* shader;
+		std::vector<std::string> files;
+		std::vector<FileStamp> stamps;
+	};
+	std::vector<Watched> watched;
+	std::vector<ShaderVariants*> variantSets;
+
+#ifdef __linux__
+	int inotifyFd = -1;
+	//Watch descriptors and the directories they are for
+	std::vector<std::pair<int, std::string>> directories;
+#else
+	double lastPoll = 0.0;
+#endif
+
+	//Adds a file, returning the path used to match change events
+	std::string Track(const std::string& file);
+	//Tracks every file a shader was built from
+	void Files(Watched& w);
+	//Starts watching the built variants of the watched sets that are not watched yet
+	void Adopt();
+};
@@ -0,0 +1,131 @@
+#include "streamBuffer.h"
+
+#include<cstring>
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr size)
+	: target(target), size(size)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(target, ID);
+	if (gl_extensions.bufferStorage)
+	{
+		// Immutable storage can stay mapped while the GPU reads from it
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, size, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(target, 0, size, flags);
+	}
+	else
+	{
+		glBufferData(target, size, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(target, 0);
+}
+
+GLintptr StreamBuffer::Write(const void* data, GLsizeiptr bytes, GLsizeiptr alignment) {
+	GLintptr offset = Allocate(bytes, alignment);
+	if (offset < 0)
+		return -1;
+
+	if (mapped != NULL)
+	{
+		memcpy(mapped + offset, data, bytes);
+	}
+	else
+	{
+		// Unsynchronized is safe here since the fences already keep us off ranges still in use
+		Bind();
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		void* range = glMapBufferRange(target, offset, bytes, flags);
+		memcpy(range, data, bytes);
+		glUnmapBuffer(target);
+		Unbind();
+	}
+	head = offset + bytes;
+	return offset;
+}
+
+void StreamBuffer::EndFrame() {
+	if (head == frameStart)
+		return;
+	inFlight.push_back({ frameStart, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+	frameStart = head;
+}
+
+void StreamBuffer::Retire() {
+	while (!inFlight.empty())
+	{
+		GLenum status = glClientWaitSync(inFlight.front().fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+		glDeleteSync(inFlight.front().fence);
+		inFlight.pop_front();
+	}
+}
+
+GLintptr StreamBuffer::Allocate(GLsizeiptr bytes, GLsizeiptr alignment) {
+	if (bytes > size)
+		return -1;
+	while (true)
+	{
+		Retire();
+		// Used space runs in ring order from the oldest unfinished write up to head
+		GLintptr oldest = !inFlight.empty() ? inFlight.front().start : frameStart;
+		if (inFlight.empty() && frameStart == head)
+		{
+			head = frameStart = 0;
+			return 0;
+		}
+		GLintptr start = (head + alignment - 1) / alignment * alignment;
+		if (start >= oldest && head >= oldest)
+		{
+			// Free space runs from start to the end of the buffer, then from 0 up to the oldest write
+			if (start + bytes <= size)
+			{
+				// A frame starting on a fresh lap begins at the write, not at the skipped padding
+				if (frameStart == head)
+					frameStart = start;
+				return start;
+			}
+			if (bytes < oldest)
+			{
+				if (frameStart == head)
+					frameStart = 0;
+				return 0;
+			}
+		}
+		else if (start + bytes < oldest)
+		{
+			// Already wrapped, the free space ends at the oldest write
+			if (frameStart == head)
+				frameStart = start;
+			return start;
+		}
+		// This frame alone has filled the ring
+		if (inFlight.empty())
+			return -1;
+		// Full, wait for the GPU to finish with the oldest frame
+		glClientWaitSync(inFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	}
+}
+
+void StreamBuffer::Bind() {
+	glBindBuffer(target, ID);
+}
+
+void StreamBuffer::Unbind() {
+	glBindBuffer(target, 0);
+}
+
+void StreamBuffer::Delete() {
+	for (InFlight& frame : inFlight)
+		glDeleteSync(frame.fence);
+	inFlight.clear();
+	if (mapped != NULL)
+	{
+		Bind();
+		glUnmapBuffer(target);
+		Unbind();
+		mapped = NULL;
+	}
+	glDeleteBuffers(1, &ID);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<deque>
+
+#include "glExtensions.h"
+
+//Class is a vertex (or index) buffer for data that changes every frame, like particles, debug lines or UI
+//One large buffer is mapped once, persistently where ARB_buffer_storage allows, and each write takes
+//the next free range of it like a ring. Ranges are fenced per frame so nothing is overwritten while the
+//GPU may still read it, which avoids glBufferData orphaning and the driver copies that come with it
+class StreamBuffer
+{
+public:
+	GLuint ID;
+	GLenum target;
+	GLsizeiptr size;
+
+	//Size the buffer for about three frames of data so writes never have to wait
+	StreamBuffer(GLenum target, GLsizeiptr size);
+
+	//Copies data into the ring and returns its offset in the buffer, or -1 if it is larger than the buffer
+	//Offsets are multiples of alignment; pass the vertex stride to draw with offset / stride as the first vertex
+	//Only waits for the GPU if the whole ring is still in use
+	GLintptr Write(const void* data, GLsizeiptr bytes, GLsizeiptr alignment = 16);
+	//Fences everything written this frame, call once after the draws that read it
+	void EndFrame();
+
+	void Bind();
+	void Unbind();
+	void Delete();
+
+private:
+	//The writes of one frame, which the GPU may still be reading from
+	struct InFlight
+	{
+		GLintptr start;
+		GLsync fence;
+	};
+
+	//Persistently mapped pointer when ARB_buffer_storage is available
+	unsigned char* mapped = NULL;
+	GLintptr head = 0;
+	//Where the writes of the current frame, not fenced yet, begin
+	GLintptr frameStart = 0;
+	std::deque<InFlight> inFlight;
+
+	//Frees frames whose fences have signaled
+	void Retire();
+	//Finds room for bytes, waiting on the oldest frame if the ring is full
+	GLintptr Allocate(GLsizeiptr bytes, GLsizeiptr alignment);
+};
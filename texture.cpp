@@ -1,15 +1,52 @@
 #include "texture.h"
+#include "mipmap.h"
 
-Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType) {
-	//Assigns the type of texture to the texture object
-	type = texType;
-	
-	//Stores the width, height, and the number of color channels of the image
-	int widthImg, heightImg, numColCh;
+static int channelsFor(GLenum format) {
+	switch (format)
+	{
+	case GL_RED: return 1;
+	case GL_RG: return 2;
+	case GL_RGB: return 3;
+	default: return 4;
+	}
+}
+
+void TextureImage::Free() {
+	stbi_image_free(bytes);
+	bytes = NULL;
+}
+
+TextureImage load_texture_image(const char* image, GLenum format) {
+	TextureImage result;
 	// Flips the image so it appears right side up
-	stbi_set_flip_vertically_on_load(true);
+	// The per-thread flag is used since this may run on several decode threads at once
+	stbi_set_flip_vertically_on_load_thread(true);
 	// Reads the image from a file and stores it in bytes
-	unsigned char* bytes = stbi_load("resources/pots2k2k.png", &widthImg, &heightImg, &numColCh, 0);
+	// Asking for the channel count of the format keeps a 3 channel jpg from being read as RGBA garbage
+	result.numColCh = channelsFor(format);
+	result.bytes = stbi_load(image, &result.width, &result.height, NULL, result.numColCh);
+	if (result.bytes == NULL)
+	{
+		std::cout << "TEXTURE_LOAD_ERROR for:" << image << "\n" << stbi_failure_reason() << std::endl;
+	}
+	return result;
+}
+
+Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
+	: Texture(texType, slot, format, pixelType)
+{
+	TextureImage texels = load_texture_image(image, format);
+	Upload(texels);
+	// Deletes the image data as it is already in the OpenGL Texture object
+	texels.Free();
+}
+
+Texture::Texture(GLenum texType, GLenum slot, GLenum format, GLenum pixelType) {
+	//Assigns the type of texture to the texture object
+	type = texType;
+	Texture::slot = slot;
+	Texture::format = format;
+	Texture::pixelType = pixelType;
 
 	//Generate OpenGL texture object
 	glGenTextures(1, &ID);
@@ -29,25 +66,120 @@ Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format,
 	// float flatColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
 	// glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, flatColor);
 
-	// Assigns the image to the OpenGL Texture object
-	glTexImage2D(texType, 0, GL_RGBA, widthImg, heightImg, 0, format, pixelType, bytes);
-	glGenerateMipmap(texType);
-
-	// Deletes the image data as it is already in the OpenGL Texture object
-	stbi_image_free(bytes);
+	// A single grey texel is shown until the real image has been decoded and uploaded
+	unsigned char placeholder[] = { 128, 128, 128, 255 };
+	glTexImage2D(texType, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	bytes = 4;
 
 	// Unbinds the OpenGL Texture object so that it can't accidentally be modified
 	glBindTexture(texType, 0);
+}
+
+void Texture::Upload(const TextureImage& image) {
+	if (image.bytes == NULL)
+		return;
+
+	glActiveTexture(slot);
+	glBindTexture(type, ID);
+	// Rows of 1 and 3 channel images are not always a multiple of 4 bytes long
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	// Assigns the image to the OpenGL Texture object
+	glTexImage2D(type, 0, GL_RGBA, image.width, image.height, 0, format, pixelType, image.bytes);
+	// Undo any level clamp left behind by a compressed upload
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, 1000);
+	glGenerateMipmap(type);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(type, 0);
+	// Stored as RGBA, and a full mip chain adds a third on top of level 0
+	bytes = (size_t)image.width * image.height * 4 * 4 / 3;
+	loaded = true;
+}
+
+void Texture::Upload(const TextureImage& image, const std::vector<MipLevel>& mips) {
+	if (image.bytes == NULL)
+		return;
+
+	glActiveTexture(slot);
+	glBindTexture(type, ID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(type, 0, GL_RGBA, image.width, image.height, 0, format, pixelType, image.bytes);
+	bytes = (size_t)image.width * image.height * 4;
+	for (size_t i = 0; i < mips.size(); i++)
+	{
+		glTexImage2D(type, (GLint)i + 1, GL_RGBA, mips[i].width, mips[i].height, 0, format, pixelType, mips[i].texels.data());
+		bytes += (size_t)mips[i].width * mips[i].height * 4;
+	}
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, (GLint)mips.size());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(type, 0);
+	loaded = true;
+}
+
+void Texture::Upload(const KtxFile& file) {
+	if (file.levels.empty())
+		return;
+
+	glActiveTexture(slot);
+	glBindTexture(type, ID);
+	// Every level is already in the file, so there is nothing for glGenerateMipmap to do
+	for (size_t i = 0; i < file.levels.size(); i++)
+	{
+		const KtxLevel& level = file.levels[i];
+		glCompressedTexImage2D(type, (GLint)i, file.internalFormat, level.width, level.height, 0, (GLsizei)level.size, level.data);
+	}
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, (GLint)file.levels.size() - 1);
+	glBindTexture(type, 0);
+	bytes = file.Size();
+	loaded = true;
+}
+
+void Texture::Allocate(int width, int height, int levels) {
+	glBindTexture(type, ID);
+	bytes = 0;
+	for (int i = 0; i < levels; i++)
+	{
+		glTexImage2D(type, i, GL_RGBA, width, height, 0, format, pixelType, NULL);
+		bytes += (size_t)width * height * 4;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	glBindTexture(type, 0);
+}
 
+void Texture::SubImage(GLint level, GLint x, GLint y, GLsizei width, GLsizei height, const void* pixels) {
+	glBindTexture(type, ID);
+	glTexSubImage2D(type, level, x, y, width, height, format, pixelType, pixels);
+	glBindTexture(type, 0);
+}
+
+void Texture::LevelRange(int baseLevel, int maxLevel) {
+	glBindTexture(type, ID);
+	glTexParameteri(type, GL_TEXTURE_BASE_LEVEL, baseLevel);
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, maxLevel);
+	glBindTexture(type, 0);
+}
+
+void Texture::GenerateMipmap() {
+	glBindTexture(type, ID);
+	glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, 1000);
+	glGenerateMipmap(type);
+	glBindTexture(type, 0);
+	bytes = bytes * 4 / 3;
+}
+
+void Texture::Adopt(Texture& other) {
+	Delete();
+	ID = other.ID;
+	bytes = other.bytes;
+	loaded = true;
+	// The other texture no longer owns the OpenGL object
+	other.ID = 0;
+}
 
-}	
 void Texture::texUnit(Shader& shader, const char* uniform, GLuint unit) {
-	// Gets the location of the uniform
-	GLuint texUni = glGetUniformLocation(shader.ID, uniform);
-	// Shader needs to be activated before changing the value of a uniform
-	shader.Activate();
-	// Sets the value of the uniform
-	glUniform1i(texUni, unit);
+	// Sets the value of the uniform, the shader activates itself if it needs to
+	shader.set(uniform, (int)unit);
 }
 void Texture::Bind() {
 	glBindTexture(type, ID);
@@ -59,4 +191,4 @@ void Texture::Unbind() {
 
 void Texture::Delete() {
 	glDeleteTextures(1, &ID);
-}
\ No newline at end of file
+}
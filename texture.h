@@ -5,18 +5,65 @@
 #include<stb/stb_image.h>
 
 #include "shaderClass.h"
+#include "ktxFile.h"
 
 //Function to read the shader text files
 std::string get_file_contents(const char* filename);
 
+struct MipLevel;
+
+//Decoded image data waiting to be given to OpenGL
+struct TextureImage
+{
+	int width = 0;
+	int height = 0;
+	int numColCh = 0;
+	unsigned char* bytes = NULL;
+
+	//Number of bytes the texels take up
+	size_t Size() const { return (size_t)width * height * numColCh; }
+	//Releases the texels once they have been uploaded
+	void Free();
+};
+
+//Decodes an image file, forcing the channel count implied by the OpenGL format
+//Safe to call from worker threads
+TextureImage load_texture_image(const char* image, GLenum format);
+
 //Class produces an OpenGL texture class
 class Texture
 {
 public:
 	GLuint ID;
 	GLenum type;
+	GLenum slot;
+	GLenum format;
+	GLenum pixelType;
+	//False while the texture is still showing its placeholder
+	bool loaded = false;
+	//Estimate of the video memory used by all levels
+	size_t bytes = 0;
+
 	Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
+	//Creates the texture with a 1x1 placeholder so it can be bound before the image arrives
+	Texture(GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
 
+	//Replaces the current contents with decoded image data, letting the driver build the mipmaps
+	void Upload(const TextureImage& image);
+	//Replaces the current contents with decoded image data and a mip chain built on the CPU
+	void Upload(const TextureImage& image, const std::vector<MipLevel>& mips);
+	//Replaces the current contents with a block compressed mip chain
+	void Upload(const KtxFile& file);
+	//Gives the texture empty storage for a number of mip levels, to be filled with SubImage
+	void Allocate(int width, int height, int levels);
+	//Updates a rectangle of one level; pixels is an offset when a pixel unpack buffer is bound
+	void SubImage(GLint level, GLint x, GLint y, GLsizei width, GLsizei height, const void* pixels);
+	//Limits sampling to levels baseLevel..maxLevel, so partly loaded levels are never used
+	void LevelRange(int baseLevel, int maxLevel);
+	//Builds mipmaps from level 0 on the GPU
+	void GenerateMipmap();
+	//Deletes our OpenGL texture and takes over another one that has finished loading
+	void Adopt(Texture& other);
 	//Assigns a texture unit to a texture
 	void texUnit(Shader& shader, const char* uniform, GLuint unit);
 	//binds a texture
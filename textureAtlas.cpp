@@ -0,0 +1,239 @@
+#include "textureAtlas.h"
+
+#include<algorithm>
+#include<numeric>
+
+#include "mipmap.h"
+
+//A horizontal run of the packed outline: everything below y is taken
+struct SkylineSegment
+{
+	int x;
+	int y;
+	int width;
+};
+
+//Class packs rectangles into one page
+class SkylinePacker
+{
+public:
+	SkylinePacker(int size)
+		: size(size)
+	{
+		skyline.push_back({ 0, 0, size });
+	}
+
+	//Places a rectangle as low as possible, returning false if it does not fit
+	bool Insert(int width, int height, int alignment, int& outX, int& outY) {
+		int bestIndex = -1, bestTop = size + 1, bestX = 0, bestY = 0;
+		for (size_t i = 0; i < skyline.size(); i++)
+		{
+			int x = (skyline[i].x + alignment - 1) / alignment * alignment;
+			int y;
+			if (!Fits(i, x, width, height, alignment, y))
+				continue;
+			if (y + height < bestTop)
+			{
+				bestIndex = (int)i;
+				bestTop = y + height;
+				bestX = x;
+				bestY = y;
+			}
+		}
+		if (bestIndex < 0)
+			return false;
+		Place(bestX, bestY + height, width);
+		outX = bestX;
+		outY = bestY;
+		return true;
+	}
+
+private:
+	int size;
+	std::vector<SkylineSegment> skyline;
+
+	//Finds the lowest aligned y a rectangle at x can sit at, resting on the segments under it
+	bool Fits(size_t index, int x, int width, int height, int alignment, int& y) {
+		if (x + width > size)
+			return false;
+		y = 0;
+		for (size_t i = index; i < skyline.size() && skyline[i].x < x + width; i++)
+		{
+			if (skyline[i].x + skyline[i].width <= x)
+				continue;
+			if (skyline[i].y > y)
+				y = skyline[i].y;
+		}
+		y = (y + alignment - 1) / alignment * alignment;
+		return y + height <= size;
+	}
+
+	//Raises the outline over [x, x + width) to top
+	void Place(int x, int top, int width) {
+		std::vector<SkylineSegment> updated;
+		for (const SkylineSegment& s : skyline)
+		{
+			int end = s.x + s.width;
+			// Keep the parts of the segment either side of the new rectangle
+			if (s.x < x)
+				updated.push_back({ s.x, s.y, std::min(end, x) - s.x });
+			if (s.x <= x && end > x)
+				updated.push_back({ x, top, width });
+			if (end > x + width)
+			{
+				int start = std::max(s.x, x + width);
+				updated.push_back({ start, s.y, end - start });
+			}
+		}
+		// Merge neighbours at the same height
+		skyline.clear();
+		for (const SkylineSegment& s : updated)
+		{
+			if (!skyline.empty() && skyline.back().y == s.y)
+				skyline.back().width += s.width;
+			else
+				skyline.push_back(s);
+		}
+	}
+};
+
+std::vector<AtlasRegion> pack_atlas(const std::vector<glm::ivec2>& sizes, int pageSize, int padding, int alignment) {
+	std::vector<AtlasRegion> regions(sizes.size());
+	// Tallest first packs much tighter with a skyline
+	std::vector<size_t> order(sizes.size());
+	std::iota(order.begin(), order.end(), (size_t)0);
+	std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a].y > sizes[b].y; });
+
+	std::vector<SkylinePacker> pages;
+	for (size_t index : order)
+	{
+		AtlasRegion& region = regions[index];
+		region.width = sizes[index].x;
+		region.height = sizes[index].y;
+		region.layer = -1;
+		int paddedWidth = (region.width + 2 * padding + alignment - 1) / alignment * alignment;
+		int paddedHeight = (region.height + 2 * padding + alignment - 1) / alignment * alignment;
+		if (paddedWidth > pageSize || paddedHeight > pageSize)
+			continue;
+
+		int x = 0, y = 0;
+		for (size_t page = 0; page <= pages.size(); page++)
+		{
+			if (page == pages.size())
+				pages.push_back(SkylinePacker(pageSize));
+			if (pages[page].Insert(paddedWidth, paddedHeight, alignment, x, y))
+			{
+				region.layer = (int)page;
+				break;
+			}
+		}
+		region.x = x + padding;
+		region.y = y + padding;
+		region.offset = glm::vec2(region.x, region.y) / (float)pageSize;
+		region.scale = glm::vec2(region.width, region.height) / (float)pageSize;
+	}
+	return regions;
+}
+
+TextureAtlas::TextureAtlas(const std::vector<TextureImage>& images, int pageSize, int padding, int mipLevels, GLenum slot)
+	: slot(slot), pageSize(pageSize)
+{
+	std::vector<glm::ivec2> sizes;
+	for (const TextureImage& image : images)
+		sizes.push_back(glm::ivec2(image.width, image.height));
+	// A texel at level L covers 2^L texels of level 0, so regions are aligned and padded to that
+	int alignment = 1 << (mipLevels - 1);
+	if (padding < alignment)
+		padding = alignment;
+	regions = pack_atlas(sizes, pageSize, padding, alignment);
+	for (const AtlasRegion& region : regions)
+		layers = std::max(layers, region.layer + 1);
+
+	// Copy each image into its page, extruding its edge texels into the padding around it
+	std::vector<TextureImage> pages(layers);
+	for (TextureImage& page : pages)
+	{
+		page.width = pageSize;
+		page.height = pageSize;
+		page.numColCh = 4;
+		page.bytes = (unsigned char*)calloc(page.Size(), 1);
+	}
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const AtlasRegion& region = regions[i];
+		const TextureImage& image = images[i];
+		if (region.layer < 0)
+			continue;
+		unsigned char* page = pages[region.layer].bytes;
+		for (int y = -padding; y < region.height + padding; y++)
+		{
+			int sy = glm::clamp(y, 0, region.height - 1);
+			int py = region.y + y;
+			if (py < 0 || py >= pageSize)
+				continue;
+			for (int x = -padding; x < region.width + padding; x++)
+			{
+				int sx = glm::clamp(x, 0, region.width - 1);
+				int px = region.x + x;
+				if (px < 0 || px >= pageSize)
+					continue;
+				const unsigned char* src = image.bytes + ((size_t)sy * image.width + sx) * image.numColCh;
+				unsigned char* dst = page + ((size_t)py * pageSize + px) * 4;
+				for (int c = 0; c < 4; c++)
+					dst[c] = c < image.numColCh ? src[c] : 255;
+			}
+		}
+	}
+
+	glGenTextures(1, &ID);
+	glActiveTexture(slot);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// Repeating would wrap into a neighbouring image, so atlases always clamp
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int level = 0, size = pageSize; level < mipLevels; level++, size = std::max(size / 2, 1))
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	for (int layer = 0; layer < layers; layer++)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, pageSize, pageSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, pages[layer].bytes);
+		std::vector<MipLevel> mips = build_mip_chain(pages[layer], MipFilter::Box, true);
+		for (int level = 1; level < mipLevels && level - 1 < (int)mips.size(); level++)
+		{
+			const MipLevel& mip = mips[level - 1];
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, mip.texels.data());
+		}
+		pages[layer].Free();
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureAtlas::texUnit(Shader& shader, const char* uniform, GLuint unit) {
+	shader.set(uniform, (int)unit);
+}
+
+void TextureAtlas::Bind() {
+	glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+}
+
+void TextureAtlas::Unbind() {
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureAtlas::Delete() {
+	glDeleteTextures(1, &ID);
+}
+
+void remap_uvs(GLfloat* vertices, int vertexCount, int stride, int uvOffset, int layerOffset, const AtlasRegion& region) {
+	for (int i = 0; i < vertexCount; i++)
+	{
+		GLfloat* uv = vertices + i * stride + uvOffset;
+		uv[0] = uv[0] * region.scale.x + region.offset.x;
+		uv[1] = uv[1] * region.scale.y + region.offset.y;
+		vertices[i * stride + layerOffset] = (GLfloat)region.layer;
+	}
+}
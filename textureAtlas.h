@@ -0,0 +1,57 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "texture.h"
+#include "shaderClass.h"
+
+//Where one source image ended up inside the atlas
+struct AtlasRegion
+{
+	//Array layer (page) the image is on
+	int layer;
+	//Texel rectangle of the image itself, not counting its padding
+	int x;
+	int y;
+	int width;
+	int height;
+	//Maps the image's own 0..1 texture coordinates into the page: uv * scale + offset
+	glm::vec2 offset;
+	glm::vec2 scale;
+};
+
+//Packs rectangles into square pages with a skyline bottom-left packer
+//Each rectangle gets padding texels on every side and starts on a multiple of alignment,
+//which keeps mip levels up to log2(alignment) from bleeding between neighbours
+//Rectangles that do not fit on an empty page get a layer of -1
+std::vector<AtlasRegion> pack_atlas(const std::vector<glm::ivec2>& sizes, int pageSize, int padding, int alignment);
+
+//Class merges many small RGBA images into one GL_TEXTURE_2D_ARRAY, so objects using
+//different images can be drawn with a single texture bind
+//Only texture coordinates that stay inside 0..1 can be remapped; repeating textures need their own texture
+class TextureAtlas
+{
+public:
+	GLuint ID;
+	GLenum slot;
+	int pageSize;
+	int layers = 0;
+	//One region per image passed to the constructor, in the same order
+	std::vector<AtlasRegion> regions;
+
+	//mipLevels is how many levels are built; padding is extruded from each image's edge texels
+	TextureAtlas(const std::vector<TextureImage>& images, int pageSize, int padding, int mipLevels, GLenum slot);
+
+	//Assigns a texture unit to the atlas
+	void texUnit(Shader& shader, const char* uniform, GLuint unit);
+	void Bind();
+	void Unbind();
+	void Delete();
+};
+
+//Rewrites the texture coordinates of interleaved vertices to point into an atlas region,
+//and writes the region's layer for the ATLAS shader variant to sample
+//stride, uvOffset and layerOffset are counted in floats, e.g. 6, 3 and 5 for AtlasVertex in main.cpp
+void remap_uvs(GLfloat* vertices, int vertexCount, int stride, int uvOffset, int layerOffset, const AtlasRegion& region);
@@ -0,0 +1,74 @@
+#include "textureCache.h"
+
+#include<cstdio>
+
+#include "blockCompress.h"
+#include "hash.h"
+#include "mipmap.h"
+
+//Bump when the encoder or file layout changes so old entries are ignored
+static const unsigned long long cacheVersion = 2;
+
+static bool isOpaque(const TextureImage& image) {
+	if (image.numColCh != 4)
+		return true;
+	for (size_t i = 3; i < image.Size(); i += 4)
+	{
+		if (image.bytes[i] != 255)
+			return false;
+	}
+	return true;
+}
+
+TextureCache::TextureCache(const char* directory)
+	: directory(directory)
+{
+}
+
+std::string TextureCache::EntryFor(const char* image, GLenum format) {
+	MappedFile source;
+	if (!source.Open(image))
+		return std::string();
+	unsigned long long key[2] = { cacheVersion, format };
+	unsigned long long hash = hash_bytes(key, sizeof(key));
+	hash = hash_bytes(source.data, source.size, hash);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.ktx2", hash);
+	return directory + "/" + name;
+}
+
+bool TextureCache::Open(const char* image, GLenum format, KtxFile& file) {
+	std::string entry = EntryFor(image, format);
+	return !entry.empty() && file.Open(entry.c_str());
+}
+
+bool TextureCache::Cook(const char* image, GLenum format) {
+	std::string entry = EntryFor(image, format);
+	if (entry.empty())
+		return false;
+	TextureImage level = load_texture_image(image, format);
+	if (level.bytes == NULL)
+		return false;
+
+	// Opaque images drop their alpha and use BC1, which is half the size of BC3
+	bool bc1 = isOpaque(level);
+	std::vector<MipLevel> mips = build_mip_chain(level, MipFilter::Kaiser, true);
+	std::vector<std::vector<unsigned char>> levels;
+	if (bc1)
+		levels.push_back(encode_bc1(level.bytes, level.width, level.height, level.numColCh));
+	else
+		levels.push_back(encode_bc3(level.bytes, level.width, level.height));
+	level.Free();
+	for (const MipLevel& mip : mips)
+	{
+		if (bc1)
+			levels.push_back(encode_bc1(mip.texels.data(), mip.width, mip.height, level.numColCh));
+		else
+			levels.push_back(encode_bc3(mip.texels.data(), mip.width, mip.height));
+	}
+
+	make_directories(directory);
+	GLenum internalFormat = bc1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	return KtxFile::Write(entry.c_str(), internalFormat, level.width, level.height, levels);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include<string>
+
+#include "texture.h"
+#include "ktxFile.h"
+
+//Class keeps block compressed, pre-mipmapped copies of source images on disk
+//Entries are named by a hash of the source file contents, so editing an image
+//simply misses the cache instead of loading stale data
+class TextureCache
+{
+public:
+	std::string directory;
+
+	TextureCache(const char* directory);
+
+	//Path of the cache entry for an image, or an empty string if the image can not be read
+	std::string EntryFor(const char* image, GLenum format);
+	//Maps the cached copy of an image if it has been cooked
+	bool Open(const char* image, GLenum format, KtxFile& file);
+	//Decodes, mipmaps and compresses an image into the cache
+	bool Cook(const char* image, GLenum format);
+};
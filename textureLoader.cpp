@@ -0,0 +1,151 @@
+#include "textureLoader.h"
+
+TextureLoader::TextureLoader(ThreadPool& pool, size_t uploadBudget, TextureCache* cache)
+	: pool(pool), cache(cache), pbo(uploadBudget > 0 ? (GLsizeiptr)uploadBudget * 2 : PBO_UNLIMITED_SIZE, (GLsizeiptr)uploadBudget)
+{
+	// Cache entries are S3TC compressed, which core OpenGL 3.3 does not guarantee
+	if (cache != NULL && !gl_extensions.textureCompressionS3TC)
+		TextureLoader::cache = NULL;
+}
+
+std::shared_future<bool> TextureLoader::Load(Texture& texture, const char* image) {
+	//Copy the path since the caller's string may be gone before the job runs
+	std::string path(image);
+	GLenum format = texture.format;
+	TextureCache* cache = TextureLoader::cache;
+	ThreadPool* workers = cpuMipmaps ? &pool : NULL;
+	MipFilter filter = mipFilter;
+	Pending job;
+	job.texture = &texture;
+	job.image = pool.Submit([path, format, cache, workers, filter]() {
+		LoadedImage result;
+		std::shared_ptr<KtxFile> compressed = std::make_shared<KtxFile>();
+		if (cache != NULL && cache->Open(path.c_str(), format, *compressed))
+		{
+			result.compressed = compressed;
+			return result;
+		}
+		result.image = load_texture_image(path.c_str(), format);
+		// Images are authored in sRGB, so filter them in linear light
+		if (workers != NULL)
+			result.mips = build_mip_chain(result.image, filter, true, workers);
+		return result;
+	});
+	std::shared_future<bool> done = job.done.get_future().share();
+	pending.push_back(std::move(job));
+	return done;
+}
+
+void TextureLoader::Update() {
+	pbo.BeginFrame();
+
+	// Carry on with images that are already streaming, oldest first
+	for (size_t i = 0; i < streaming.size();)
+	{
+		if (!Stream(streaming[i]))
+			return;
+		// Every level is in, swap the finished texture in for the placeholder
+		streaming[i].texture->Adopt(streaming[i].staging);
+		streaming[i].image.Free();
+		streaming[i].done.set_value(true);
+		streaming.erase(streaming.begin() + i);
+	}
+
+	for (size_t i = 0; i < pending.size();)
+	{
+		// Skip images that are still decoding
+		if (!pending[i].ready && pending[i].image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			i++;
+			continue;
+		}
+		if (!pending[i].ready)
+		{
+			pending[i].loaded = pending[i].image.get();
+			pending[i].ready = true;
+		}
+		// Cache entries go out whole, so wait for a frame with room for all of one
+		if (pending[i].loaded.compressed && !pbo.HasBudget(pending[i].loaded.compressed->Size()))
+			return;
+
+		LoadedImage loaded = std::move(pending[i].loaded);
+		Texture* texture = pending[i].texture;
+		std::promise<bool> done = std::move(pending[i].done);
+		pending.erase(pending.begin() + i);
+		if (loaded.compressed)
+		{
+			// Cache entries are mapped files already, so they go straight to OpenGL
+			texture->Upload(*loaded.compressed);
+			pbo.uploadedThisFrame += loaded.compressed->Size();
+			done.set_value(true);
+			continue;
+		}
+		if (loaded.image.bytes == NULL)
+		{
+			done.set_value(false);
+			continue;
+		}
+
+		Streaming s{ texture, Texture(texture->type, texture->slot, texture->format, texture->pixelType), loaded.image, std::move(loaded.mips), 0, 0, std::move(done) };
+		s.staging.Allocate(loaded.image.width, loaded.image.height, (int)s.mips.size() + 1);
+		streaming.push_back(std::move(s));
+		if (!Stream(streaming.back()))
+			return;
+		texture->Adopt(streaming.back().staging);
+		streaming.back().image.Free();
+		streaming.back().done.set_value(true);
+		streaming.pop_back();
+	}
+}
+
+bool TextureLoader::Stream(Streaming& s) {
+	while (s.level <= (int)s.mips.size())
+	{
+		int width = s.level == 0 ? s.image.width : s.mips[s.level - 1].width;
+		int height = s.level == 0 ? s.image.height : s.mips[s.level - 1].height;
+		const unsigned char* texels = s.level == 0 ? s.image.bytes : s.mips[s.level - 1].texels.data();
+		GLsizeiptr rowBytes = (GLsizeiptr)width * s.image.numColCh;
+
+		// Send as many rows as the frame budget allows, but never more than a quarter of the ring
+		int rows = (int)(pbo.Room(rowBytes) / rowBytes);
+		if (rows > height - s.row)
+			rows = height - s.row;
+		if (rows <= 0)
+			return false;
+
+		if (!pbo.Upload(s.staging, s.level, 0, s.row, width, rows, texels + s.row * rowBytes, rows * rowBytes))
+			return false;
+		s.row += rows;
+		if (s.row == height)
+		{
+			s.level++;
+			s.row = 0;
+		}
+	}
+	// Without CPU mips only level 0 was sent, let the driver fill in the rest
+	if (s.mips.empty())
+		s.staging.GenerateMipmap();
+	return true;
+}
+
+bool TextureLoader::Busy() {
+	return !pending.empty() || !streaming.empty();
+}
+
+void TextureLoader::Delete() {
+	for (Pending& p : pending)
+	{
+		LoadedImage loaded = p.ready ? std::move(p.loaded) : p.image.get();
+		loaded.image.Free();
+		p.done.set_value(false);
+	}
+	pending.clear();
+	for (Streaming& s : streaming)
+	{
+		s.image.Free();
+		s.staging.Delete();
+		s.done.set_value(false);
+	}
+	streaming.clear();
+	pbo.Delete();
+}
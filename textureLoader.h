@@ -0,0 +1,79 @@
+#pragma once
+
+#include<future>
+#include<memory>
+#include<string>
+#include<vector>
+
+#include "texture.h"
+#include "threadPool.h"
+#include "textureCache.h"
+#include "mipmap.h"
+#include "PBO.h"
+
+//Class decodes textures on a thread pool and streams them to OpenGL through a PBO ring,
+//a band of rows at a time, so big images never freeze a frame
+//Textures keep their placeholder until every level has arrived
+class TextureLoader
+{
+public:
+	//An uploadBudget of 0 means no per frame limit
+	//When a cache is given, cooked images are mapped from it instead of being decoded
+	//Must be created on the thread that owns the OpenGL context
+	TextureLoader(ThreadPool& pool, size_t uploadBudget, TextureCache* cache = NULL);
+
+	//Build mipmaps on the worker threads instead of with glGenerateMipmap
+	bool cpuMipmaps = true;
+	MipFilter mipFilter = MipFilter::Kaiser;
+
+	//Starts loading an image for a texture that was made with the placeholder constructor
+	//The returned future becomes true once every level is in the texture, or false if the image
+	//could not be read or the loader was deleted first; it is set by Update, so only wait on it
+	//from other threads and poll it from the OpenGL one
+	std::shared_future<bool> Load(Texture& texture, const char* image);
+	//Streams finished images, stopping once uploadBudget bytes have been sent this frame
+	//Must be called on the thread that owns the OpenGL context
+	void Update();
+	//True while any image is still decoding or waiting to upload
+	bool Busy();
+	//Waits for outstanding decodes and frees their data
+	void Delete();
+
+private:
+	//Result of a load job: either a compressed cache entry or decoded texels
+	struct LoadedImage
+	{
+		std::shared_ptr<KtxFile> compressed;
+		TextureImage image;
+		std::vector<MipLevel> mips;
+	};
+	struct Pending
+	{
+		Texture* texture;
+		std::future<LoadedImage> image;
+		std::promise<bool> done;
+		//Result taken from image, kept here while a compressed entry waits for budget
+		LoadedImage loaded;
+		bool ready = false;
+	};
+	//A decoded image part way through being uploaded into a staging texture
+	struct Streaming
+	{
+		Texture* texture;
+		Texture staging;
+		TextureImage image;
+		std::vector<MipLevel> mips;
+		int level;
+		int row;
+		std::promise<bool> done;
+	};
+
+	ThreadPool& pool;
+	TextureCache* cache;
+	PBO pbo;
+	std::vector<Pending> pending;
+	std::vector<Streaming> streaming;
+
+	//Uploads the next rows of an image, returning true once it is complete
+	bool Stream(Streaming& s);
+};
@@ -0,0 +1,66 @@
+#include "textureManager.h"
+
+TextureManager::TextureManager(TextureLoader& loader, size_t budget)
+	: budget(budget), loader(loader)
+{
+}
+
+Texture& TextureManager::Load(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType) {
+	entries.push_front({ Texture(texType, slot, format, pixelType), image, frame, false });
+	lookup[&entries.front().texture] = entries.begin();
+	// List nodes never move, so the loader can hold on to this texture
+	loader.Load(entries.front().texture, image);
+	return entries.front().texture;
+}
+
+void TextureManager::Bind(Texture& texture) {
+	auto found = lookup.find(&texture);
+	if (found != lookup.end())
+	{
+		auto it = found->second;
+		if (it->evicted)
+		{
+			stats.misses++;
+			it->evicted = false;
+			loader.Load(it->texture, it->image.c_str());
+		}
+		else
+		{
+			stats.hits++;
+		}
+		it->lastUsed = frame;
+		// Move to the front so the back of the list is always the least recently used
+		entries.splice(entries.begin(), entries, it);
+	}
+	texture.Bind();
+}
+
+void TextureManager::Update() {
+	size_t resident = 0;
+	for (Entry& entry : entries)
+		resident += entry.texture.bytes;
+
+	// Evict from the least recently used end, but never anything bound this frame
+	// or still loading, since the loader will overwrite it when it finishes
+	for (auto it = entries.rbegin(); it != entries.rend() && resident > budget; ++it)
+	{
+		if (it->lastUsed == frame || !it->texture.loaded)
+			continue;
+		resident -= it->texture.bytes;
+		Texture& texture = it->texture;
+		texture.Delete();
+		texture = Texture(texture.type, texture.slot, texture.format, texture.pixelType);
+		resident += texture.bytes;
+		it->evicted = true;
+		stats.evictions++;
+	}
+	stats.residentBytes = resident;
+	frame++;
+}
+
+void TextureManager::Delete() {
+	for (Entry& entry : entries)
+		entry.texture.Delete();
+	entries.clear();
+	lookup.clear();
+}
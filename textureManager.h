@@ -0,0 +1,60 @@
+#pragma once
+
+#include<list>
+#include<string>
+#include<unordered_map>
+
+#include "texture.h"
+#include "textureLoader.h"
+
+//Counters describing how well the textures fit the memory budget
+struct TextureStats
+{
+	//Binds of textures that were in memory
+	unsigned long long hits = 0;
+	//Binds of evicted textures, which show their placeholder while they stream back in
+	unsigned long long misses = 0;
+	unsigned long long evictions = 0;
+	size_t residentBytes = 0;
+};
+
+//Class owns the textures loaded from image files and keeps their memory under a budget
+//When over budget the least recently bound textures are evicted, and they are
+//streamed back in through the TextureLoader the next time they are bound
+class TextureManager
+{
+public:
+	//Bytes of texture memory allowed before evicting
+	size_t budget;
+	TextureStats stats;
+
+	TextureManager(TextureLoader& loader, size_t budget);
+
+	//Creates a texture for an image and starts loading it
+	//The reference stays valid until Delete
+	Texture& Load(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
+	//Binds a texture and marks it as recently used, reloading it first if it was evicted
+	void Bind(Texture& texture);
+	//Evicts textures until under budget, call once per frame after the loader's Update
+	void Update();
+	//Deletes every texture
+	void Delete();
+
+private:
+	struct Entry
+	{
+		Texture texture;
+		std::string image;
+		//Frame this texture was last bound on
+		unsigned long long lastUsed;
+		//True from eviction until the loader has been asked for it again
+		bool evicted;
+	};
+
+	TextureLoader& loader;
+	//Most recently bound first
+	std::list<Entry> entries;
+	//Finds a texture's entry without walking the list on every bind
+	std::unordered_map<Texture*, std::list<Entry>::iterator> lookup;
+	unsigned long long frame = 0;
+};
@@ -0,0 +1,174 @@
+#include "textureStreamer.h"
+
+#include<cmath>
+#include<queue>
+
+TextureStreamer::TextureStreamer(ThreadPool& pool, size_t uploadBudget)
+	: pool(pool), pbo(uploadBudget > 0 ? (GLsizeiptr)uploadBudget * 2 : PBO_UNLIMITED_SIZE, (GLsizeiptr)uploadBudget)
+{
+}
+
+void TextureStreamer::Load(Texture& texture, const char* image, glm::vec3 center, float radius) {
+	std::string path(image);
+	GLenum format = texture.format;
+	ThreadPool* workers = &pool;
+	Stream s;
+	s.texture = &texture;
+	s.center = center;
+	s.radius = radius;
+	s.decoding = pool.Submit([path, format, workers]() {
+		Decoded result;
+		result.image = load_texture_image(path.c_str(), format);
+		result.mips = build_mip_chain(result.image, MipFilter::Kaiser, true, workers);
+		return result;
+	});
+	s.decoded = false;
+	s.baseLevel = 0;
+	s.row = 0;
+	s.wantedLevel = 0;
+	streams.push_back(std::move(s));
+}
+
+void TextureStreamer::Move(Texture& texture, glm::vec3 center, float radius) {
+	for (Stream& s : streams)
+	{
+		if (s.texture == &texture)
+		{
+			s.center = center;
+			s.radius = radius;
+		}
+	}
+}
+
+void TextureStreamer::Start(Stream& s) {
+	Texture& texture = *s.texture;
+	int levels = (int)s.levels.mips.size() + 1;
+	texture.Allocate(s.levels.image.width, s.levels.image.height, levels);
+
+	// The tail is tiny, so it skips the PBO and its budget
+	// An image that is small enough is all tail, level 0 included
+	s.baseLevel = levels;
+	s.row = 0;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int level = levels - 1; level >= 0; level--)
+	{
+		int width = level == 0 ? s.levels.image.width : s.levels.mips[level - 1].width;
+		int height = level == 0 ? s.levels.image.height : s.levels.mips[level - 1].height;
+		if (width > tailSize || height > tailSize)
+			break;
+		const unsigned char* texels = level == 0 ? s.levels.image.bytes : s.levels.mips[level - 1].texels.data();
+		texture.SubImage(level, 0, 0, width, height, texels);
+		s.baseLevel = level;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	// Until some level is in there is nothing real to sample, so the placeholder stays
+	if (s.baseLevel == levels)
+		return;
+	texture.LevelRange(s.baseLevel, levels - 1);
+	texture.loaded = true;
+	if (s.baseLevel == 0)
+	{
+		s.levels.image.Free();
+		s.levels.mips.clear();
+	}
+}
+
+bool TextureStreamer::Refine(Stream& s) {
+	int level = s.baseLevel - 1;
+	int width = level == 0 ? s.levels.image.width : s.levels.mips[level - 1].width;
+	int height = level == 0 ? s.levels.image.height : s.levels.mips[level - 1].height;
+	const unsigned char* texels = level == 0 ? s.levels.image.bytes : s.levels.mips[level - 1].texels.data();
+	GLsizeiptr rowBytes = (GLsizeiptr)width * s.levels.image.numColCh;
+
+	int rows = (int)(pbo.Room(rowBytes) / rowBytes);
+	if (rows > height - s.row)
+		rows = height - s.row;
+	if (rows <= 0 || !pbo.Upload(*s.texture, level, 0, s.row, width, rows, texels + s.row * rowBytes, rows * rowBytes))
+		return false;
+
+	s.row += rows;
+	if (s.row == height)
+	{
+		// The level is complete, let the sampler use it
+		s.baseLevel = level;
+		s.row = 0;
+		s.texture->LevelRange(s.baseLevel, (int)s.levels.mips.size());
+		s.texture->loaded = true;
+		// Full resolution is in and the CPU copy is no longer needed
+		if (level == 0)
+		{
+			s.levels.image.Free();
+			s.levels.mips.clear();
+		}
+	}
+	return true;
+}
+
+void TextureStreamer::Update(const Camera& camera, float FOVdeg) {
+	pbo.BeginFrame();
+
+	// Pixels on screen per world unit at a distance of 1
+	float pixelsPerUnit = camera.height / (2.0f * std::tan(glm::radians(FOVdeg) / 2.0f));
+
+	// Most urgent first: the biggest objects on screen that are furthest from the level they need
+	typedef std::pair<float, Stream*> Candidate;
+	std::priority_queue<Candidate> queue;
+	for (Stream& s : streams)
+	{
+		if (!s.decoded)
+		{
+			if (s.decoding.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				continue;
+			s.levels = s.decoding.get();
+			s.decoded = true;
+			if (s.levels.image.bytes == NULL)
+				continue;
+			Start(s);
+		}
+		if (s.baseLevel == 0)
+			continue;
+
+		float distance = glm::length(s.center - camera.Position) - s.radius;
+		float screenSize = 2.0f * s.radius * pixelsPerUnit / (distance > 0.01f ? distance : 0.01f);
+		// Level L is about size >> L texels wide, pick the finest one that is not bigger than the object on screen
+		int size = s.levels.image.width > s.levels.image.height ? s.levels.image.width : s.levels.image.height;
+		int wanted = 0;
+		while (wanted < s.baseLevel && (size >> (wanted + 1)) >= screenSize)
+			wanted++;
+		s.wantedLevel = wanted;
+		if (s.baseLevel > wanted)
+			queue.push({ screenSize * (s.baseLevel - wanted), &s });
+	}
+
+	while (!queue.empty())
+	{
+		Stream& s = *queue.top().second;
+		queue.pop();
+		// Keep refining the most urgent texture until it is done or the frame budget runs out
+		while (s.baseLevel > s.wantedLevel)
+		{
+			if (!Refine(s))
+				return;
+		}
+	}
+}
+
+bool TextureStreamer::Busy() {
+	for (Stream& s : streams)
+	{
+		if (!s.decoded || s.baseLevel > s.wantedLevel)
+			return true;
+	}
+	return false;
+}
+
+void TextureStreamer::Delete() {
+	for (Stream& s : streams)
+	{
+		if (!s.decoded)
+			s.levels = s.decoding.get();
+		s.levels.image.Free();
+	}
+	streams.clear();
+	pbo.Delete();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include<vector>
+#include<glm/glm/glm.hpp>
+
+#include "texture.h"
+#include "threadPool.h"
+#include "mipmap.h"
+#include "camera.h"
+#include "PBO.h"
+
+//Class streams large textures in from their smallest mip level upward
+//The mip tail is uploaded as soon as the image is decoded so something shows right away,
+//then finer levels are added over the following frames, most needed first. A level only
+//becomes visible once it is complete, by lowering GL_TEXTURE_BASE_LEVEL to it.
+class TextureStreamer
+{
+public:
+	//Levels at or below this size are uploaded together as soon as the image is decoded
+	int tailSize = 64;
+
+	TextureStreamer(ThreadPool& pool, size_t uploadBudget);
+
+	//Starts streaming an image into a texture made with the placeholder constructor
+	//center and radius bound the object the texture is drawn on, in world space
+	void Load(Texture& texture, const char* image, glm::vec3 center, float radius);
+	//Updates where a texture's object is
+	void Move(Texture& texture, glm::vec3 center, float radius);
+	//Uploads the levels that matter most from this camera, within the frame budget
+	//Must be called on the thread that owns the OpenGL context
+	void Update(const Camera& camera, float FOVdeg);
+	//True while any texture is below the level its object needs
+	bool Busy();
+	void Delete();
+
+private:
+	struct Decoded
+	{
+		TextureImage image;
+		std::vector<MipLevel> mips;
+	};
+	struct Stream
+	{
+		Texture* texture;
+		glm::vec3 center;
+		float radius;
+		std::future<Decoded> decoding;
+		Decoded levels;
+		bool decoded;
+		//Finest level that is complete and visible
+		int baseLevel;
+		//Rows already sent of the level being streamed (baseLevel - 1)
+		int row;
+		//Finest level the object needs at its current size on screen
+		int wantedLevel;
+	};
+
+	ThreadPool& pool;
+	PBO pbo;
+	std::vector<Stream> streams;
+
+	//Sets up storage and uploads the mip tail once an image is decoded
+	void Start(Stream& s);
+	//Uploads the next rows of the next finer level, returning false when out of budget
+	bool Refine(Stream& s);
+};
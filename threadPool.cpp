@@ -0,0 +1,112 @@
+#include "threadPool.h"
+
+ThreadPool::ThreadPool(unsigned int numThreads) {
+	if (numThreads == 0)
+	{
+		//hardware_concurrency is allowed to return 0 when it does not know
+		unsigned int hardware = std::thread::hardware_concurrency();
+		numThreads = hardware > 1 ? hardware - 1 : 1;
+	}
+	for (unsigned int i = 0; i < numThreads; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	//Threads that are still joinable at destruction would terminate the program
+	Delete();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	//Shared with helper jobs, which may only start after this call has returned
+	struct State
+	{
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+		size_t count;
+		size_t grain;
+		const std::function<void(size_t, size_t)>* body;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	auto state = std::make_shared<State>();
+	state->count = count;
+	state->grain = grain;
+	state->body = &body;
+
+	// Every thread claims chunks until none are left, so a late helper never touches body
+	auto work = [state]() {
+		while (true)
+		{
+			size_t begin = state->next.fetch_add(state->grain);
+			if (begin >= state->count)
+				return;
+			size_t end = begin + state->grain < state->count ? begin + state->grain : state->count;
+			(*state->body)(begin, end);
+			if (state->done.fetch_add(end - begin) + (end - begin) == state->count)
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->finished.notify_all();
+			}
+		}
+	};
+
+	size_t chunks = (count + grain - 1) / grain;
+	size_t helpers = chunks - 1 < workers.size() ? chunks - 1 : workers.size();
+	if (helpers > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t i = 0; i < helpers; i++)
+				jobs.push(work);
+		}
+		wake.notify_all();
+	}
+	work();
+
+	// Waiting on chunk completion rather than on helper jobs means a busy pool can not deadlock us
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state]() { return state->done.load() == state->count; });
+}
+
+unsigned int ThreadPool::Size() {
+	return (unsigned int)workers.size();
+}
+
+void ThreadPool::Delete() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+	workers.clear();
+}
+
+void ThreadPool::WorkerLoop() {
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			// Sleep until there is a job or the pool is shutting down
+			wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			// Drain the queue before exiting so no future is left without a value
+			if (jobs.empty())
+				return;
+			job = std::move(jobs.front());
+			jobs.pop();
+		}
+		job();
+	}
+}
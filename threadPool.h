@@ -0,0 +1,63 @@
+#pragma once
+
+#include<atomic>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<functional>
+#include<future>
+#include<memory>
+#include<queue>
+#include<vector>
+
+//Class keeps a fixed set of worker threads alive and hands them jobs
+//so slow work like image decoding does not run on the render thread
+class ThreadPool
+{
+public:
+	//Zero threads means one per hardware thread (minus the render thread)
+	ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	//Queues a job and returns a future that will hold its result
+	//Once the pool has been deleted the job runs on the calling thread instead, so the future is never left empty
+	template<typename F>
+	auto Submit(F&& job) -> std::future<decltype(job())>
+	{
+		using Result = decltype(job());
+		//packaged_task is move only, so share it with the std::function that goes in the queue
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+		std::future<Result> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!stopping)
+			{
+				jobs.push([task]() { (*task)(); });
+				task = NULL;
+			}
+		}
+		if (task != NULL)
+			(*task)();
+		else
+			wake.notify_one();
+		return result;
+	}
+
+	//Splits [0, count) into chunks of grain items and runs body(begin, end) on them in parallel
+	//The calling thread works on chunks too, so this is safe to call from inside a job
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+	//Number of worker threads
+	unsigned int Size();
+	//Finishes the queued jobs and joins the worker threads
+	void Delete();
+
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	void WorkerLoop();
+};
@@ -0,0 +1,524 @@
+#include "tools.h"
+
+#include<algorithm>
+#include<chrono>
+#include<cstdlib>
+#include<cstring>
+#include<deque>
+#include<iostream>
+
+#include "textureCache.h"
+#include "mipmap.h"
+#include "textureAtlas.h"
+#include "meshOptimizer.h"
+#include "meshlets.h"
+#include "boundsCulling.h"
+#include "occlusionCulling.h"
+#include "commandBucket.h"
+#include "PBO.h"
+
+#include<glm/glm/gtc/matrix_transform.hpp>
+
+//Where the game looks for cooked textures
+static const char* textureCacheDir = "cache/textures";
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int cook(int argc, char** argv) {
+	TextureCache cache(textureCacheDir);
+	int failures = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		if (cache.Cook(argv[i], GL_RGBA))
+		{
+			std::cout << "cooked " << argv[i] << " -> " << cache.EntryFor(argv[i], GL_RGBA) << " in " << millisecondsSince(start) << " ms\n";
+		}
+		else
+		{
+			std::cout << "COOK_ERROR for:" << argv[i] << "\n";
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+static int benchCache(const char* image) {
+	TextureCache cache(textureCacheDir);
+
+	// Cold start: what Texture does without the cache, decode then let the driver build mips
+	auto start = std::chrono::steady_clock::now();
+	TextureImage decoded = load_texture_image(image, GL_RGBA);
+	double coldMs = millisecondsSince(start);
+	if (decoded.bytes == NULL)
+		return 1;
+	// A full mip chain adds a third on top of the base level
+	size_t coldBytes = decoded.Size() * 4 / 3;
+	decoded.Free();
+
+	if (!cache.Cook(image, GL_RGBA))
+		return 1;
+
+	// Warm start: hash the source, map the entry and touch every page as an upload would
+	start = std::chrono::steady_clock::now();
+	KtxFile file;
+	if (!cache.Open(image, GL_RGBA, file))
+		return 1;
+	unsigned int checksum = 0;
+	for (const KtxLevel& level : file.levels)
+	{
+		for (size_t i = 0; i < level.size; i += 4096)
+			checksum += level.data[i];
+	}
+	double warmMs = millisecondsSince(start);
+
+	std::cout << "cold: " << coldMs << " ms, " << coldBytes / 1024 << " KB of texels\n";
+	std::cout << "warm: " << warmMs << " ms, " << file.Size() / 1024 << " KB of texels (" << (double)coldBytes / file.Size() << "x smaller)\n";
+	std::cout << "(checksum " << checksum << ")\n";
+	return 0;
+}
+
+static int benchMips(const char* image) {
+	TextureImage decoded = load_texture_image(image, GL_RGBA);
+	if (decoded.bytes == NULL)
+		return 1;
+	ThreadPool pool;
+
+	const char* names[] = { "box", "kaiser", "lanczos" };
+	MipFilter filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+	bool identical = true;
+	for (int f = 0; f < 3; f++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::vector<MipLevel> scalar = build_mip_chain(decoded, filters[f], true, NULL, true);
+		double scalarMs = millisecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		std::vector<MipLevel> simd = build_mip_chain(decoded, filters[f], true);
+		double simdMs = millisecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		std::vector<MipLevel> threaded = build_mip_chain(decoded, filters[f], true, &pool);
+		double threadedMs = millisecondsSince(start);
+
+		// Every path has to produce the same bytes
+		for (size_t i = 0; i < scalar.size(); i++)
+		{
+			if (scalar[i].texels != simd[i].texels || scalar[i].texels != threaded[i].texels)
+				identical = false;
+		}
+		std::cout << names[f] << ": scalar " << scalarMs << " ms, " << mip_simd_name() << " " << simdMs << " ms, "
+			<< mip_simd_name() << " x" << pool.Size() + 1 << " threads " << threadedMs << " ms\n";
+	}
+	decoded.Free();
+	std::cout << (identical ? "outputs identical\n" : "MIP_MISMATCH between scalar and SIMD output\n");
+	return identical ? 0 : 1;
+}
+
+static int packAtlas(int pageSize, int argc, char** argv) {
+	std::vector<glm::ivec2> sizes;
+	for (int i = 3; i < argc; i++)
+	{
+		int width, height, channels;
+		if (!stbi_info(argv[i], &width, &height, &channels))
+		{
+			std::cout << "TEXTURE_LOAD_ERROR for:" << argv[i] << "\n";
+			return 1;
+		}
+		sizes.push_back(glm::ivec2(width, height));
+	}
+
+	// Same padding and alignment a 5 level TextureAtlas uses
+	std::vector<AtlasRegion> regions = pack_atlas(sizes, pageSize, 16, 16);
+	int layers = 0;
+	long long used = 0;
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		const AtlasRegion& r = regions[i];
+		if (r.layer < 0)
+		{
+			std::cout << argv[i + 3] << ": too big for a " << pageSize << " page\n";
+			continue;
+		}
+		std::cout << argv[i + 3] << ": layer " << r.layer << " at " << r.x << "," << r.y << " size " << r.width << "x" << r.height << "\n";
+		layers = std::max(layers, r.layer + 1);
+		used += (long long)r.width * r.height;
+	}
+	if (layers > 0)
+		std::cout << layers << " layer(s), " << 100.0 * used / ((double)layers * pageSize * pageSize) << "% of texels used\n";
+	return 0;
+}
+
+//Builds a gridSize x gridSize vertex grid whose triangles are in random order, as an exporter might leave them
+static void shuffledGrid(int gridSize, std::vector<glm::vec3>& positions, std::vector<GLuint>& indices) {
+	for (int y = 0; y < gridSize; y++)
+	{
+		for (int x = 0; x < gridSize; x++)
+			positions.push_back(glm::vec3((float)x, (float)y, std::sin(x * 0.1f) * std::cos(y * 0.1f) * 4.0f));
+	}
+	std::vector<glm::uvec3> triangles;
+	for (int y = 0; y + 1 < gridSize; y++)
+	{
+		for (int x = 0; x + 1 < gridSize; x++)
+		{
+			GLuint i = (GLuint)(y * gridSize + x);
+			triangles.push_back(glm::uvec3(i, i + 1, i + gridSize));
+			triangles.push_back(glm::uvec3(i + 1, i + gridSize + 1, i + gridSize));
+		}
+	}
+	srand(1);
+	for (size_t i = triangles.size(); i > 1; i--)
+		std::swap(triangles[i - 1], triangles[rand() % i]);
+	for (const glm::uvec3& t : triangles)
+		indices.insert(indices.end(), { t.x, t.y, t.z });
+}
+
+static int benchMesh(int gridSize) {
+	std::vector<glm::vec3> positions;
+	std::vector<GLuint> indices;
+	shuffledGrid(gridSize, positions, indices);
+	std::cout << positions.size() << " vertices, " << indices.size() / 3 << " triangles\n";
+
+	auto report = [&](const char* stage, double ms) {
+		VertexCacheStats stats = analyze_vertex_cache(indices.data(), indices.size(), positions.size());
+		std::cout << stage << ": ACMR " << stats.acmr << " ATVR " << stats.atvr;
+		if (ms >= 0.0)
+			std::cout << " in " << ms << " ms";
+		std::cout << "\n";
+	};
+	report("original", -1.0);
+
+	auto start = std::chrono::steady_clock::now();
+	optimize_vertex_cache(indices.data(), indices.size(), positions.size());
+	report("vertex cache", millisecondsSince(start));
+
+	start = std::chrono::steady_clock::now();
+	optimize_overdraw(indices.data(), indices.size(), positions.data(), positions.size());
+	report("overdraw", millisecondsSince(start));
+
+	start = std::chrono::steady_clock::now();
+	size_t used = optimize_vertex_fetch(positions.data(), positions.size(), sizeof(glm::vec3), indices.data(), indices.size());
+	report("vertex fetch", millisecondsSince(start));
+	return used == positions.size() ? 0 : 1;
+}
+
+//Builds a closed sphere of radius 1 with segments slices around and segments / 2 stacks
+static void sphere(int segments, std::vector<glm::vec3>& positions, std::vector<GLuint>& indices) {
+	int stacks = std::max(segments / 2, 2);
+	for (int y = 0; y <= stacks; y++)
+	{
+		float phi = 3.14159265f * y / stacks;
+		for (int x = 0; x <= segments; x++)
+		{
+			float theta = 2.0f * 3.14159265f * x / segments;
+			positions.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+		}
+	}
+	for (int y = 0; y < stacks; y++)
+	{
+		for (int x = 0; x < segments; x++)
+		{
+			GLuint i = (GLuint)(y * (segments + 1) + x);
+			GLuint below = i + segments + 1;
+			indices.insert(indices.end(), { i, i + 1, below, i + 1, below + 1, below });
+		}
+	}
+}
+
+static int benchMeshlets(int segments) {
+	std::vector<glm::vec3> positions;
+	std::vector<GLuint> indices;
+	sphere(segments, positions, indices);
+	optimize_vertex_cache(indices.data(), indices.size(), positions.size());
+
+	auto start = std::chrono::steady_clock::now();
+	MeshletMesh mesh = build_meshlets(indices.data(), indices.size(), positions.data(), positions.size());
+	std::cout << indices.size() / 3 << " triangles in " << mesh.meshlets.size() << " meshlets, built in " << millisecondsSince(start) << " ms\n";
+
+	// Close enough that the sides of the sphere fall outside a narrow view and its back faces away
+	glm::vec3 camera(0.0f, 0.0f, 2.5f);
+	glm::mat4 viewProj = glm::perspective(glm::radians(30.0f), 16.0f / 9.0f, 0.1f, 100.0f) * glm::lookAt(camera, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = frustum_from_matrix(viewProj);
+	MeshletCuller culler(mesh);
+	ThreadPool pool;
+	std::vector<unsigned int> visible;
+	size_t kept = 0;
+	auto run = [&](const char* name, ThreadPool* p, bool scalar) {
+		const int repeats = 20;
+		auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; i++)
+			kept = culler.Cull(frustum, camera, visible, p, scalar);
+		std::cout << name << ": " << millisecondsSince(begin) / repeats << " ms\n";
+	};
+	run("scalar", NULL, true);
+	run(cull_simd_name(), NULL, false);
+	run("threaded", &pool, false);
+	std::cout << visible.size() << " meshlets visible, " << kept << " of " << indices.size() / 3 << " triangles kept\n";
+	return 0;
+}
+
+//Scatters count boxes and spheres through a 200 unit cube around a camera and times culling them
+static int benchCulling(int count) {
+	BoundsCuller culler;
+	srand(1);
+	auto random = [](float low, float high) { return low + (high - low) * (float)rand() / RAND_MAX; };
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 center(random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f));
+		if (i % 2 == 0)
+			culler.AddSphere(center, random(0.1f, 2.0f));
+		else
+			culler.AddBox(center - glm::vec3(random(0.1f, 2.0f)), center + glm::vec3(random(0.1f, 2.0f)));
+	}
+	Frustum frustum = frustum_from_matrix(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f)
+		* glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+	ThreadPool pool;
+	std::vector<unsigned int> reference, visible;
+	culler.Cull(frustum, reference, NULL, true);
+	bool matches = true;
+	auto run = [&](const char* name, ThreadPool* p, bool scalar) {
+		const int repeats = 20;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; i++)
+			culler.Cull(frustum, visible, p, scalar);
+		double ms = millisecondsSince(start) / repeats;
+		std::cout << name << ": " << ms << " ms, " << count / ms / 1000.0 << "k objects per ms\n";
+		matches = matches && visible == reference;
+	};
+	run("scalar", NULL, true);
+	run(bounds_simd_name(), NULL, false);
+	run("threaded", &pool, false);
+	std::cout << reference.size() << " of " << count << " objects visible\n";
+	if (!matches)
+		std::cout << "CULL_MISMATCH: SIMD or threaded results differ from scalar\n";
+	return matches ? 0 : 1;
+}
+
+//Hides a field of boxes behind a wall and a dense sphere and times drawing them into the CPU depth buffer
+static int benchOcclusion(int boxes) {
+	std::vector<glm::vec3> wall = { glm::vec3(-6.0f, -4.0f, -10.0f), glm::vec3(6.0f, -4.0f, -10.0f), glm::vec3(6.0f, 4.0f, -10.0f), glm::vec3(-6.0f, 4.0f, -10.0f) };
+	std::vector<GLuint> wallIndices = { 0, 1, 2, 0, 2, 3 };
+	std::vector<glm::vec3> ball;
+	std::vector<GLuint> ballIndices;
+	sphere(256, ball, ballIndices);
+	glm::mat4 ballModel = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(9.0f, 0.0f, -12.0f)), glm::vec3(3.0f));
+
+	glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f)
+		* glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	OcclusionCuller culler(256, 128);
+	ThreadPool pool;
+	auto start = std::chrono::steady_clock::now();
+	culler.Begin(viewProj);
+	culler.AddOccluder(wall.data(), 0, wallIndices.data(), wallIndices.size());
+	culler.AddOccluder(ball.data(), 0, ballIndices.data(), ballIndices.size(), ballModel);
+	std::cout << culler.TriangleCount() << " occluder triangles set up in " << millisecondsSince(start) << " ms\n";
+
+	std::vector<float> reference;
+	size_t differing = 0;
+	auto run = [&](const char* name, ThreadPool* p, bool scalar) {
+		const int repeats = 20;
+		auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; i++)
+			culler.Rasterize(p, scalar);
+		std::cout << name << ": " << millisecondsSince(begin) / repeats << " ms\n";
+		if (reference.empty())
+			reference = culler.Depth();
+		for (size_t i = 0; i < reference.size(); i++)
+			differing += reference[i] != culler.Depth()[i] ? 1 : 0;
+	};
+	run("scalar", NULL, true);
+	run(occlusion_simd_name(), NULL, false);
+	run("threaded", &pool, false);
+	if (differing > 0)
+		std::cout << differing << " depth values differ from scalar\n";
+
+	srand(1);
+	auto random = [](float low, float high) { return low + (high - low) * (float)rand() / RAND_MAX; };
+	std::vector<glm::vec3> centers;
+	for (int i = 0; i < boxes; i++)
+		centers.push_back(glm::vec3(random(-20.0f, 20.0f), random(-10.0f, 10.0f), random(-40.0f, -2.0f)));
+	size_t hidden = 0;
+	start = std::chrono::steady_clock::now();
+	for (const glm::vec3& c : centers)
+		hidden += culler.TestBox(c - glm::vec3(0.5f), c + glm::vec3(0.5f)) ? 0 : 1;
+	std::cout << hidden << " of " << boxes << " boxes hidden, tested in " << millisecondsSince(start) << " ms\n";
+
+	// A box right behind the wall has to be hidden and one in front of it must not be
+	bool behind = !culler.TestBox(glm::vec3(-1.0f, -1.0f, -14.0f), glm::vec3(1.0f, 1.0f, -12.0f));
+	bool front = culler.TestBox(glm::vec3(-1.0f, -1.0f, -9.0f), glm::vec3(1.0f, 1.0f, -8.0f));
+	if (!behind || !front)
+		std::cout << "OCCLUSION_ERROR: boxes around the wall were classified wrongly\n";
+	return behind && front ? 0 : 1;
+}
+
+//Times sorting draws made from random programs, textures and VAOs and counts the state changes saved
+static int benchBucket(int draws) {
+	srand(1);
+	std::vector<SortEntry> entries, scratch;
+	for (int i = 0; i < draws; i++)
+	{
+		SortEntry entry = { draw_sort_key(rand() % 2, 1 + rand() % 16, 1 + rand() % 64, 1 + rand() % 32, (float)rand() / RAND_MAX), (unsigned int)i };
+		entries.push_back(entry);
+	}
+	// Binds a replay would make: a field change costs one bind
+	auto changes = [](const std::vector<SortEntry>& list, int shift, unsigned long long mask) {
+		size_t count = 0;
+		for (size_t i = 0; i < list.size(); i++)
+			count += i == 0 || ((list[i].key >> shift) & mask) != ((list[i - 1].key >> shift) & mask) ? 1 : 0;
+		return count;
+	};
+	std::cout << "submission order: " << changes(entries, 48, 0xFFFF) << " program, " << changes(entries, 32, 0xFFFFFFFF) << " texture, "
+		<< changes(entries, 20, 0xFFFFFFFFFFFULL) << " VAO changes\n";
+
+	std::vector<SortEntry> reference = entries;
+	auto start = std::chrono::steady_clock::now();
+	std::stable_sort(reference.begin(), reference.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+	std::cout << "std::stable_sort: " << millisecondsSince(start) << " ms\n";
+	start = std::chrono::steady_clock::now();
+	radix_sort(entries, scratch);
+	std::cout << "radix_sort: " << millisecondsSince(start) << " ms\n";
+	std::cout << "sorted: " << changes(entries, 48, 0xFFFF) << " program, " << changes(entries, 32, 0xFFFFFFFF) << " texture, "
+		<< changes(entries, 20, 0xFFFFFFFFFFFULL) << " VAO changes\n";
+
+	bool matches = true;
+	for (size_t i = 0; i < entries.size(); i++)
+		matches = matches && entries[i].key == reference[i].key && entries[i].packet == reference[i].packet;
+	if (!matches)
+		std::cout << "SORT_MISMATCH: radix_sort differs from std::stable_sort\n";
+	return matches ? 0 : 1;
+}
+
+//Records draws for a field of objects into a bucket, on one thread and then chunked over a pool
+static int benchRecord(int objects) {
+	srand(1);
+	auto random = [](float low, float high) { return low + (high - low) * (float)rand() / RAND_MAX; };
+	std::vector<glm::vec4> spheres;
+	for (int i = 0; i < objects; i++)
+		spheres.push_back(glm::vec4(random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(0.5f, 2.0f)));
+	glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f)
+		* glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = frustum_from_matrix(viewProj);
+
+	// What a job does per object: cull it, then build its key and packet; nothing is ever flushed here
+	auto record = [&](size_t begin, size_t end, CommandList& list) {
+		for (size_t i = begin; i < end; i++)
+		{
+			const glm::vec4& s = spheres[i];
+			bool inside = true;
+			for (const glm::vec4& p : frustum.planes)
+				inside = inside && glm::dot(glm::vec3(p), glm::vec3(s)) + p.w >= -s.w;
+			if (!inside)
+				continue;
+			DrawPacket packet;
+			packet.count = 36;
+			float depth = sort_depth(viewProj, glm::vec3(s));
+			list.Submit(draw_sort_key(0, 1 + (GLuint)i % 16, 1 + (GLuint)i % 64, 1 + (GLuint)i % 32, depth), packet);
+		}
+	};
+
+	const int repeats = 10;
+	CommandList single;
+	size_t serialSize = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; r++)
+	{
+		CommandBucket bucket;
+		single.Clear();
+		record(0, spheres.size(), single);
+		bucket.Append(single);
+		serialSize = bucket.Size();
+	}
+	std::cout << "one thread: " << millisecondsSince(start) / repeats << " ms\n";
+
+	ThreadPool pool;
+	size_t parallelSize = 0;
+	start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; r++)
+	{
+		CommandBucket bucket;
+		bucket.Record(pool, spheres.size(), 4096, record);
+		parallelSize = bucket.Size();
+	}
+	std::cout << pool.Size() + 1 << " threads: " << millisecondsSince(start) / repeats << " ms\n";
+	std::cout << serialSize << " of " << objects << " objects recorded\n";
+	if (serialSize != parallelSize)
+		std::cout << "RECORD_MISMATCH: " << parallelSize << " draws recorded in parallel\n";
+	return serialSize == parallelSize ? 0 : 1;
+}
+
+//Places uploads in a simulated upload ring the way PBO does, with the GPU finishing them at random,
+//and checks no upload lands on one still in flight
+static int benchRing(int uploads) {
+	srand(1);
+	const GLsizeiptr ringSize = 1024 * 1024;
+	struct Range { GLintptr start, end; };
+	std::deque<Range> inFlight;
+	GLintptr head = 0;
+	size_t placed = 0, refused = 0, overlaps = 0;
+	auto place = [&](GLsizeiptr bytes) {
+		GLintptr start = inFlight.empty() ? 0 : pbo_ring_allocate(ringSize, head, inFlight.front().start, bytes);
+		if (start < 0)
+		{
+			refused++;
+			return false;
+		}
+		for (const Range& range : inFlight)
+			overlaps += start < range.end && range.start < start + bytes ? 1 : 0;
+		inFlight.push_back({ start, start + bytes });
+		head = start + bytes;
+		placed++;
+		return true;
+	};
+
+	// Quarter ring uploads fill it to the end exactly, then the wrapped ones run up to the oldest range
+	for (int i = 0; i < 4; i++)
+		place(ringSize / 4);
+	inFlight.pop_front();
+	inFlight.pop_front();
+	for (int i = 0; i < 3; i++)
+		place(ringSize / 4);
+
+	// Row multiples that divide the ring, so exact fits keep happening
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < uploads; i++)
+	{
+		while (!inFlight.empty() && rand() % 3 == 0)
+			inFlight.pop_front();
+		place((GLsizeiptr)4096 << (rand() % 6));
+	}
+	std::cout << uploads << " uploads: " << millisecondsSince(start) << " ms, " << placed << " placed, " << refused << " refused while full\n";
+	if (overlaps > 0)
+		std::cout << "RING_OVERLAP: " << overlaps << " uploads landed on data still in flight\n";
+	return overlaps == 0 ? 0 : 1;
+}
+
+int run_tool(int argc, char** argv) {
+	if (strcmp(argv[1], "--cook") == 0)
+		return cook(argc, argv);
+	if (strcmp(argv[1], "--bench-cache") == 0 && argc > 2)
+		return benchCache(argv[2]);
+	if (strcmp(argv[1], "--bench-mips") == 0 && argc > 2)
+		return benchMips(argv[2]);
+	if (strcmp(argv[1], "--pack") == 0 && argc > 3)
+		return packAtlas(atoi(argv[2]), argc, argv);
+
+	if (strcmp(argv[1], "--bench-mesh") == 0)
+		return benchMesh(argc > 2 ? atoi(argv[2]) : 256);
+	if (strcmp(argv[1], "--bench-meshlets") == 0)
+		return benchMeshlets(argc > 2 ? atoi(argv[2]) : 1024);
+	if (strcmp(argv[1], "--bench-culling") == 0)
+		return benchCulling(argc > 2 ? atoi(argv[2]) : 1000000);
+	if (strcmp(argv[1], "--bench-occlusion") == 0)
+		return benchOcclusion(argc > 2 ? atoi(argv[2]) : 100000);
+	if (strcmp(argv[1], "--bench-bucket") == 0)
+		return benchBucket(argc > 2 ? atoi(argv[2]) : 100000);
+	if (strcmp(argv[1], "--bench-record") == 0)
+		return benchRecord(argc > 2 ? atoi(argv[2]) : 1000000);
+	if (strcmp(argv[1], "--bench-ring") == 0)
+		return benchRing(argc > 2 ? atoi(argv[2]) : 1000000);
+	std::cout << "Unknown arguments, try --cook, --bench-cache, --bench-mips, --pack, --bench-mesh, --bench-meshlets, --bench-culling, --bench-occlusion, --bench-bucket, --bench-record or --bench-ring\n";
+	return 1;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+//Runs a command line tool instead of opening the window
+//	--cook <image>...          compresses images into the texture cache
+//	--bench-cache <image>      compares a cold decode against a warm cache load
+//	--bench-mips <image>       times the CPU mip builder against its scalar reference
+//	--pack <pageSize> <image>... plans an atlas layout and reports how full the pages are
+//	--bench-mesh [gridSize]    runs the index optimizers on a shuffled grid and reports cache efficiency
+//	--bench-meshlets [segments] splits a sphere into meshlets and times culling them from a close camera
+//	--bench-culling [count]    times frustum culling of randomly scattered boxes and spheres
+//	--bench-occlusion [boxes]  times the CPU depth rasterizer and tests boxes hidden behind its occluders
+//	--bench-bucket [draws]     times sorting draw keys and counts the state changes sorting saves
+//	--bench-record [objects]   times recording draws on one thread against recording them over a pool
+//	--bench-ring [uploads]     places uploads in a simulated texture upload ring and checks none overwrite one in flight
+//Returns the process exit code
+int run_tool(int argc, char** argv);
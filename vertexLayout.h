@@ -0,0 +1,108 @@
+#pragma once
+
+#include<glad/glad.h>
+#include<cstddef>
+
+#include "VAO.h"
+#include "VBO.h"
+#include "bufferArena.h"
+
+//Storage formats for vertex attributes
+//Normalized integer formats reach the shader as floats in 0..1 (unsigned) or -1..1 (signed)
+template<GLenum Type, GLint Count, GLboolean Normalized, size_t Size>
+struct AttribFormat
+{
+	static constexpr GLenum type = Type;
+	static constexpr GLint count = Count;
+	static constexpr GLboolean normalized = Normalized;
+	//Bytes one value takes in the vertex
+	static constexpr size_t size = Size;
+};
+
+using Float1 = AttribFormat<GL_FLOAT, 1, GL_FALSE, 4>;
+using Float2 = AttribFormat<GL_FLOAT, 2, GL_FALSE, 8>;
+using Float3 = AttribFormat<GL_FLOAT, 3, GL_FALSE, 12>;
+using Float4 = AttribFormat<GL_FLOAT, 4, GL_FALSE, 16>;
+using Half2 = AttribFormat<GL_HALF_FLOAT, 2, GL_FALSE, 4>;
+using Half4 = AttribFormat<GL_HALF_FLOAT, 4, GL_FALSE, 8>;
+using UNorm8x4 = AttribFormat<GL_UNSIGNED_BYTE, 4, GL_TRUE, 4>;
+using SNorm8x4 = AttribFormat<GL_BYTE, 4, GL_TRUE, 4>;
+using UNorm16x2 = AttribFormat<GL_UNSIGNED_SHORT, 2, GL_TRUE, 4>;
+using UNorm16x4 = AttribFormat<GL_UNSIGNED_SHORT, 4, GL_TRUE, 8>;
+using SNorm16x2 = AttribFormat<GL_SHORT, 2, GL_TRUE, 4>;
+using SNorm16x4 = AttribFormat<GL_SHORT, 4, GL_TRUE, 8>;
+//Three 10 bit components and a 2 bit one packed into 32 bits, x in the lowest bits
+using UNorm10_10_10_2 = AttribFormat<GL_UNSIGNED_INT_2_10_10_10_REV, 4, GL_TRUE, 4>;
+using SNorm10_10_10_2 = AttribFormat<GL_INT_2_10_10_10_REV, 4, GL_TRUE, 4>;
+
+//One attribute of a vertex struct: its shader location, format, and where it sits in the struct
+//Use VERTEX_ATTRIB to fill in the offset and member size
+template<GLuint Location, typename Format, size_t Offset, size_t MemberSize>
+struct Attr
+{
+	static_assert(MemberSize == Format::size, "Vertex member size does not match its attribute format");
+	static_assert(Offset % 4 == 0, "Vertex attributes must start on a 4 byte boundary");
+	static constexpr GLuint location = Location;
+	static constexpr size_t offset = Offset;
+	static constexpr size_t size = Format::size;
+	using format = Format;
+};
+
+#define VERTEX_ATTRIB(location, format, vertex, member) Attr<location, format, offsetof(vertex, member), sizeof(vertex::member)>
+
+//True if no two attributes share a location or overlap in the vertex
+template<typename... Attrs>
+struct AttribsCompatible
+{
+	static constexpr bool value = true;
+};
+template<typename A, typename B, typename... Rest>
+struct AttribsCompatible<A, B, Rest...>
+{
+	static constexpr bool value = A::location != B::location
+		&& (A::offset + A::size <= B::offset || B::offset + B::size <= A::offset)
+		&& AttribsCompatible<A, Rest...>::value && AttribsCompatible<B, Rest...>::value;
+};
+
+//Byte just past the last attribute
+template<typename... Attrs>
+struct AttribsEnd
+{
+	static constexpr size_t value = 0;
+};
+template<typename A, typename... Rest>
+struct AttribsEnd<A, Rest...>
+{
+	static constexpr size_t value = A::offset + A::size > AttribsEnd<Rest...>::value ? A::offset + A::size : AttribsEnd<Rest...>::value;
+};
+
+//Describes how a vertex struct is laid out for OpenGL, checked when it is compiled
+//The stride is the size of the struct and offsets come from the struct itself, so reordering or
+//resizing members can not leave the attribute setup silently out of date. For example
+//	using PotVertex = VertexLayout<Vertex, VERTEX_ATTRIB(0, Float3, Vertex, position), VERTEX_ATTRIB(1, UNorm8x4, Vertex, color)>;
+//	PotVertex::Link(VAO1, VBO1);
+template<typename Vertex, typename... Attrs>
+struct VertexLayout
+{
+	static_assert(sizeof...(Attrs) > 0, "A vertex layout needs at least one attribute");
+	static_assert(AttribsCompatible<Attrs...>::value, "Vertex attributes overlap or share a location");
+	static_assert(sizeof(Vertex) % 4 == 0, "Vertex size must be a multiple of 4 bytes");
+	static_assert(AttribsEnd<Attrs...>::value <= sizeof(Vertex), "Vertex attributes run past the end of the vertex");
+
+	static constexpr GLsizei stride = (GLsizei)sizeof(Vertex);
+
+	//Sets up every attribute of the layout on the bound vao, reading from a VBO or StreamBuffer
+	template<typename Buffer>
+	static void Link(VAO& vao, Buffer& buffer)
+	{
+		// Expands to one LinkAttrib call per attribute, in order
+		int expand[] = { (vao.LinkAttrib(buffer, Attrs::location, Attrs::format::count, Attrs::format::type, stride, (void*)Attrs::offset, Attrs::format::normalized), 0)... };
+		(void)expand;
+	}
+	//Sets up the attributes of an arena, which must have been made with this layout's stride
+	static void Link(BufferArena& arena)
+	{
+		int expand[] = { (arena.LinkAttrib(Attrs::location, Attrs::format::count, Attrs::format::type, Attrs::offset, Attrs::format::normalized), 0)... };
+		(void)expand;
+	}
+};